@@ -0,0 +1,382 @@
+//
+// IRModule.cpp
+// 文本 LLVM IR <-> 内存 IR 的解析与打印
+//
+
+#include "IRModule.h"
+#include <sstream>
+#include <cctype>
+
+bool isIRConstant(const std::string& operand) {
+    if (operand.empty()) return false;
+    size_t start = (operand[0] == '-' || operand[0] == '+') ? 1 : 0;
+    if (start == operand.size()) return false;
+    for (size_t i = start; i < operand.size(); ++i) {
+        if (!isdigit(operand[i])) return false;
+    }
+    return true;
+}
+
+bool isBuiltinFunction(const std::string& name) {
+    return name == "getint" || name == "putint" || name == "putstr" || name == "putch";
+}
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// 按顶层逗号切分（方括号/圆括号内的逗号不切分）
+static std::vector<std::string> splitTopLevel(const std::string& s) {
+    std::vector<std::string> parts;
+    int depth = 0;
+    size_t last = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '[' || s[i] == '(') depth++;
+        else if (s[i] == ']' || s[i] == ')') depth--;
+        else if (s[i] == ',' && depth == 0) {
+            parts.push_back(trim(s.substr(last, i - last)));
+            last = i + 1;
+        }
+    }
+    parts.push_back(trim(s.substr(last)));
+    return parts;
+}
+
+// "T v" -> (T, v)：最后一个单词是值，其余为类型
+static void splitTypeValue(const std::string& s, std::string& type, std::string& value) {
+    size_t sp = s.find_last_of(' ');
+    if (sp == std::string::npos) {
+        type.clear();
+        value = s;
+    } else {
+        type = trim(s.substr(0, sp));
+        value = s.substr(sp + 1);
+    }
+}
+
+// 取出第一个单词，其余部分写入 rest（s 与 rest 可以是同一个对象）
+static std::string firstWord(std::string s, std::string& rest) {
+    size_t sp = s.find(' ');
+    if (sp == std::string::npos) {
+        rest.clear();
+        return s;
+    }
+    rest = trim(s.substr(sp + 1));
+    return s.substr(0, sp);
+}
+
+static IRInst parseInst(const std::string& line) {
+    IRInst inst;
+    inst.raw = line;
+    std::string body = line;
+    if (line[0] == '%') {
+        size_t assign = line.find(" = ");
+        if (assign == std::string::npos) return inst;
+        inst.dest = line.substr(0, assign);
+        body = trim(line.substr(assign + 3));
+    }
+    std::string rest;
+    std::string op = firstWord(body, rest);
+
+    if (op == "alloca") {
+        inst.opcode = IROpcode::Alloca;
+        inst.type = splitTopLevel(rest)[0];
+    } else if (op == "load") {
+        // load T, T* p, align 4
+        std::vector<std::string> parts = splitTopLevel(rest);
+        if (parts.size() < 2) return inst;
+        std::string ptr_type, ptr;
+        splitTypeValue(parts[1], ptr_type, ptr);
+        inst.opcode = IROpcode::Load;
+        inst.type = parts[0];
+        inst.operands = {ptr};
+    } else if (op == "store") {
+        // store T v, T* p, align 4
+        std::vector<std::string> parts = splitTopLevel(rest);
+        if (parts.size() < 2) return inst;
+        std::string val, ptr_type, ptr;
+        splitTypeValue(parts[0], inst.type, val);
+        splitTypeValue(parts[1], ptr_type, ptr);
+        inst.opcode = IROpcode::Store;
+        inst.operands = {val, ptr};
+    } else if (op == "add" || op == "sub" || op == "mul" || op == "sdiv" || op == "srem") {
+        // add [nsw] i32 a, b
+        std::string type = firstWord(rest, rest);
+        while (type == "nsw" || type == "nuw") type = firstWord(rest, rest);
+        std::vector<std::string> parts = splitTopLevel(rest);
+        if (parts.size() < 2) return inst;
+        if (op == "add") inst.opcode = IROpcode::Add;
+        else if (op == "sub") inst.opcode = IROpcode::Sub;
+        else if (op == "mul") inst.opcode = IROpcode::Mul;
+        else if (op == "sdiv") inst.opcode = IROpcode::SDiv;
+        else inst.opcode = IROpcode::SRem;
+        inst.type = type;
+        inst.operands = {parts[0], parts[1]};
+    } else if (op == "icmp") {
+        // icmp pred T a, b
+        inst.predicate = firstWord(rest, rest);
+        inst.type = firstWord(rest, rest);
+        std::vector<std::string> parts = splitTopLevel(rest);
+        if (parts.size() < 2) return inst;
+        inst.opcode = IROpcode::ICmp;
+        inst.operands = {parts[0], parts[1]};
+    } else if (op == "zext") {
+        // zext T v to T2
+        std::stringstream ss(rest);
+        std::string val;
+        ss >> inst.type >> val;
+        inst.opcode = IROpcode::Zext;
+        inst.operands = {val};
+    } else if (op == "getelementptr") {
+        // getelementptr inbounds SRC, SRC* base, i32 a[, i32 b]
+        if (rest.compare(0, 9, "inbounds ") == 0) rest = rest.substr(9);
+        std::vector<std::string> parts = splitTopLevel(rest);
+        if (parts.size() < 3) return inst;
+        inst.opcode = IROpcode::GetElementPtr;
+        inst.type = parts[0];
+        for (size_t i = 1; i < parts.size(); ++i) {
+            std::string type, val;
+            splitTypeValue(parts[i], type, val);
+            inst.operands.push_back(val);
+        }
+    } else if (op == "call") {
+        // call T @f(T1 a1, T2 a2)
+        size_t at = rest.find('@');
+        size_t lp = rest.find('(');
+        size_t rp = rest.rfind(')');
+        if (at == std::string::npos || lp == std::string::npos || rp == std::string::npos) return inst;
+        inst.opcode = IROpcode::Call;
+        inst.type = trim(rest.substr(0, at));
+        inst.callee = rest.substr(at + 1, lp - at - 1);
+        std::string args = trim(rest.substr(lp + 1, rp - lp - 1));
+        if (!args.empty()) {
+            for (const auto& arg : splitTopLevel(args)) {
+                std::string type, val;
+                splitTypeValue(arg, type, val);
+                inst.operand_types.push_back(type);
+                inst.operands.push_back(val);
+            }
+        }
+    } else if (op == "phi") {
+        // phi T [ v1, %L1 ], [ v2, %L2 ]
+        inst.type = firstWord(rest, rest);
+        inst.opcode = IROpcode::Phi;
+        for (const auto& pair : splitTopLevel(rest)) {
+            size_t lb = pair.find('['), rb = pair.rfind(']');
+            if (lb == std::string::npos || rb == std::string::npos) continue;
+            std::vector<std::string> vl = splitTopLevel(pair.substr(lb + 1, rb - lb - 1));
+            if (vl.size() != 2 || vl[1].empty()) continue;
+            inst.operands.push_back(vl[0]);
+            inst.labels.push_back(vl[1].substr(1));
+        }
+    } else if (op == "br") {
+        std::vector<std::string> parts = splitTopLevel(rest);
+        std::string kw, val;
+        if (parts.size() == 1) {
+            // br label %L
+            splitTypeValue(parts[0], kw, val);
+            inst.opcode = IROpcode::Br;
+            inst.labels = {val.substr(1)};
+        } else if (parts.size() == 3) {
+            // br i1 c, label %A, label %B
+            std::string a, b;
+            splitTypeValue(parts[0], inst.type, val);
+            splitTypeValue(parts[1], kw, a);
+            splitTypeValue(parts[2], kw, b);
+            inst.opcode = IROpcode::CondBr;
+            inst.operands = {val};
+            inst.labels = {a.substr(1), b.substr(1)};
+        }
+    } else if (op == "ret") {
+        inst.opcode = IROpcode::Ret;
+        if (rest == "void") {
+            inst.type = "void";
+        } else {
+            std::string val;
+            splitTypeValue(rest, inst.type, val);
+            inst.operands = {val};
+        }
+    }
+    return inst;
+}
+
+static std::string joinOperands(const std::vector<std::string>& ops, size_t from = 0) {
+    std::string s;
+    for (size_t i = from; i < ops.size(); ++i) {
+        if (i > from) s += ", ";
+        s += ops[i];
+    }
+    return s;
+}
+
+std::string IRInst::toString() const {
+    std::string prefix = dest.empty() ? "" : dest + " = ";
+    switch (opcode) {
+        case IROpcode::Alloca: {
+            std::string align = type == "i1" ? "1" : (type == "i32*" ? "8" : "4");
+            return prefix + "alloca " + type + ", align " + align;
+        }
+        case IROpcode::Load:
+            return prefix + "load " + type + ", " + type + "* " + operands[0] + ", align 4";
+        case IROpcode::Store:
+            return "store " + type + " " + operands[0] + ", " + type + "* " + operands[1] +
+                   ", align " + (type == "i1" ? "1" : "4");
+        case IROpcode::Add:
+        case IROpcode::Sub:
+        case IROpcode::Mul:
+        case IROpcode::SDiv:
+        case IROpcode::SRem: {
+            const char* names[] = {"add", "sub", "mul", "sdiv", "srem"};
+            int k = (int)opcode - (int)IROpcode::Add;
+            return prefix + names[k] + " " + type + " " + operands[0] + ", " + operands[1];
+        }
+        case IROpcode::ICmp:
+            return prefix + "icmp " + predicate + " " + type + " " + operands[0] + ", " + operands[1];
+        case IROpcode::Zext:
+            return prefix + "zext " + type + " " + operands[0] + " to i32";
+        case IROpcode::GetElementPtr: {
+            std::string s = prefix + "getelementptr inbounds " + type + ", " + type + "* " + operands[0];
+            for (size_t i = 1; i < operands.size(); ++i) s += ", i32 " + operands[i];
+            return s;
+        }
+        case IROpcode::Call: {
+            std::string s = prefix + "call " + type + " @" + callee + "(";
+            for (size_t i = 0; i < operands.size(); ++i) {
+                if (i > 0) s += ", ";
+                s += operand_types[i] + " " + operands[i];
+            }
+            return s + ")";
+        }
+        case IROpcode::Phi: {
+            std::string s = prefix + "phi " + type + " ";
+            for (size_t i = 0; i < operands.size(); ++i) {
+                if (i > 0) s += ", ";
+                s += "[ " + operands[i] + ", %" + labels[i] + " ]";
+            }
+            return s;
+        }
+        case IROpcode::Br:
+            return "br label %" + labels[0];
+        case IROpcode::CondBr:
+            return "br i1 " + operands[0] + ", label %" + labels[0] + ", label %" + labels[1];
+        case IROpcode::Ret:
+            if (operands.empty()) return "ret void";
+            return "ret " + type + " " + joinOperands(operands);
+        default:
+            return raw;
+    }
+}
+
+std::vector<std::string> IRBlock::successors() const {
+    if (insts.empty()) return {};
+    const IRInst& term = insts.back();
+    if (term.opcode == IROpcode::Br) return term.labels;
+    if (term.opcode == IROpcode::CondBr) {
+        if (term.labels[0] == term.labels[1]) return {term.labels[0]};
+        return term.labels;
+    }
+    return {};
+}
+
+int IRFunction::findBlock(const std::string& label) const {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].label == label) return (int)i;
+    }
+    return -1;
+}
+
+std::string IRFunction::toString() const {
+    std::string s = "define " + ret_type + " @" + name + "(";
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (i > 0) s += ", ";
+        s += params[i].first + " " + params[i].second;
+    }
+    s += ") {\n";
+    for (const auto& block : blocks) {
+        s += block.label + ":\n";
+        for (const auto& inst : block.insts) s += "  " + inst.toString() + "\n";
+    }
+    return s + "}\n";
+}
+
+// 解析 Parser 生成的文本 IR：
+// 函数外的行原样保存到 globals；函数体按标签切分基本块，
+// 终结指令之后、下一个标签之前的指令不可达，直接丢弃；没有终结指令的块补一条跳转到下一块
+IRModule IRModule::parse(const std::string& text) {
+    IRModule module;
+    std::stringstream ss(text);
+    std::string line;
+    IRFunction* func = nullptr;
+    bool dead = false; // 当前位置是否处于终结指令之后
+    while (std::getline(ss, line)) {
+        line = trim(line);
+        if (line.empty()) continue;
+        if (func == nullptr) {
+            if (line.compare(0, 7, "define ") != 0) {
+                module.globals.push_back(line);
+                continue;
+            }
+            // define i32 @func(i32 %arg1, i32* %arg2) {
+            module.functions.emplace_back();
+            func = &module.functions.back();
+            size_t at = line.find('@');
+            size_t lp = line.find('(');
+            size_t rp = line.rfind(')');
+            func->ret_type = trim(line.substr(7, at - 7));
+            func->name = line.substr(at + 1, lp - at - 1);
+            std::string params = trim(line.substr(lp + 1, rp - lp - 1));
+            if (!params.empty()) {
+                for (const auto& param : splitTopLevel(params)) {
+                    std::string type, name;
+                    splitTypeValue(param, type, name);
+                    func->params.push_back({type, name});
+                }
+            }
+            dead = false;
+            continue;
+        }
+        if (line == "}") {
+            std::vector<IRBlock>& blocks = func->blocks;
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                if (!blocks[i].insts.empty() && blocks[i].insts.back().isTerminator()) continue;
+                IRInst term;
+                if (i + 1 < blocks.size()) {
+                    term.opcode = IROpcode::Br;
+                    term.labels = {blocks[i + 1].label};
+                } else {
+                    term.opcode = IROpcode::Ret;
+                    term.type = func->ret_type;
+                    if (func->ret_type != "void") term.operands = {"0"};
+                }
+                blocks[i].insts.push_back(term);
+            }
+            func = nullptr;
+            continue;
+        }
+        if (line.back() == ':' && line.find(' ') == std::string::npos) {
+            func->blocks.emplace_back();
+            func->blocks.back().label = line.substr(0, line.size() - 1);
+            dead = false;
+            continue;
+        }
+        if (dead) continue;
+        if (func->blocks.empty()) {
+            func->blocks.emplace_back();
+            func->blocks.back().label = "entry";
+        }
+        IRInst inst = parseInst(line);
+        func->blocks.back().insts.push_back(inst);
+        if (inst.isTerminator()) dead = true;
+    }
+    return module;
+}
+
+std::string IRModule::toString() const {
+    std::string s;
+    for (const auto& g : globals) s += g + "\n";
+    for (const auto& func : functions) s += "\n" + func.toString();
+    return s;
+}
@@ -0,0 +1,63 @@
+// IRModule.h
+// 中端使用的 LLVM IR 内存表示：Module -> Function -> BasicBlock -> Instruction
+#ifndef COMPILER_IRMODULE_H
+#define COMPILER_IRMODULE_H
+
+#include <string>
+#include <vector>
+
+enum class IROpcode {
+    Alloca, Load, Store,
+    Add, Sub, Mul, SDiv, SRem,
+    ICmp, Zext, GetElementPtr, Call, Phi,
+    Br, CondBr, Ret,
+    Unknown // 无法识别的指令，原样保留文本
+};
+
+struct IRInst {
+    IROpcode opcode = IROpcode::Unknown;
+    std::string dest;                       // 定义的值 (例如 "%3")，没有则为空
+    std::string type;                       // 运算/比较/返回/load 结果/store 值/alloca 分配/gep 源元素类型
+    std::string predicate;                  // icmp 谓词 (eq, ne, slt, sgt, sle, sge；指针比较用 ult, ule, ugt, uge)
+    std::vector<std::string> operands;      // 值操作数：%x、@g 或立即数
+    std::vector<std::string> operand_types; // call 的实参类型
+    std::vector<std::string> labels;        // br 的目标块；phi 中与 operands 一一对应的前驱块
+    std::string callee;                     // call 的目标函数名（不含 @）
+    std::string raw;                        // Unknown 指令的原始文本
+
+    bool isTerminator() const {
+        return opcode == IROpcode::Br || opcode == IROpcode::CondBr || opcode == IROpcode::Ret;
+    }
+    std::string toString() const;
+};
+
+struct IRBlock {
+    std::string label;
+    std::vector<IRInst> insts;
+
+    std::vector<std::string> successors() const;
+};
+
+struct IRFunction {
+    std::string name;     // 不含 @
+    std::string ret_type; // "i32" 或 "void"
+    std::vector<std::pair<std::string, std::string>> params; // (类型, 名称)
+    std::vector<IRBlock> blocks;
+
+    int findBlock(const std::string& label) const;
+    std::string toString() const;
+};
+
+struct IRModule {
+    std::vector<std::string> globals; // 声明、全局变量与字符串常量，原样保留
+    std::vector<IRFunction> functions;
+
+    static IRModule parse(const std::string& text);
+    std::string toString() const;
+};
+
+bool isIRConstant(const std::string& operand);
+// 内置 IO 函数（getint/putint/putch/putstr）：后端直接 syscall，不读写用户内存，不算作调用
+bool isBuiltinFunction(const std::string& name);
+
+#endif //COMPILER_IRMODULE_H
@@ -0,0 +1,1904 @@
+//
+// IROptimizer.cpp
+// 中端优化 Pass 的实现
+//
+
+#include "IROptimizer.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <sstream>
+
+bool FunctionCFG::dominates(int a, int b) const {
+    if (b < 0 || idom[b] == -1) return false;
+    while (true) {
+        if (b == a) return true;
+        if (idom[b] == b) return false;
+        b = idom[b];
+    }
+}
+
+// 自然循环：回边 b -> h（h 支配 b）的循环体为 h 加上不经过 h 能到达 b 的所有块；同一循环头的回边合并
+std::map<int, std::set<int>> FunctionCFG::naturalLoops() const {
+    std::map<int, std::set<int>> loops;
+    for (int b : rpo) {
+        for (int h : succ[b]) {
+            if (!dominates(h, b)) continue;
+            std::set<int>& body = loops[h];
+            body.insert(h);
+            std::vector<int> work;
+            if (body.insert(b).second) work.push_back(b);
+            while (!work.empty()) {
+                int x = work.back();
+                work.pop_back();
+                for (int p : pred[x]) {
+                    if (idom[p] != -1 && body.insert(p).second) work.push_back(p);
+                }
+            }
+        }
+    }
+    return loops;
+}
+
+IROptimizer::IROptimizer(IRModule& module, int unroll_budget)
+    : module(module), block_count(0), value_count(0), unroll_budget(unroll_budget) {}
+
+void IROptimizer::run() {
+    findConstantGlobals();
+    call_sites.clear();
+    for (const auto& func : module.functions) {
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                if (inst.opcode == IROpcode::Call) call_sites[inst.callee]++;
+            }
+        }
+    }
+    for (auto& func : module.functions) {
+        inlineCalls(func);
+        removeUnreachableBlocks(func);
+        promoteAllocas(func);
+        removeTrivialPhis(func);
+        propagateConstants(func);
+        removeUnreachableBlocks(func);
+        removeTrivialPhis(func);
+        eliminateDeadCode(func);
+        eliminateTailRecursion(func);
+        hoistLoopInvariants(func);
+        reduceInductionVariables(func);
+        eliminateDeadCode(func);
+        unrollLoops(func);
+        rotateLoops(func);
+        propagateConstants(func); // 折叠常量初值的入口保护与完全展开后的归纳变量
+        removeUnreachableBlocks(func);
+        removeTrivialPhis(func);
+        eliminateDeadCode(func);
+        splitCriticalEdges(func);
+    }
+    removeUnusedFunctions();
+}
+
+std::string IROptimizer::newBlockLabel(const std::string& prefix) {
+    return prefix + std::to_string(block_count++);
+}
+
+std::string IROptimizer::newValueName(const std::string& prefix) {
+    return "%" + prefix + "." + std::to_string(value_count++);
+}
+
+// 构建 CFG，并用 Cooper-Harvey-Kennedy 迭代算法计算支配树
+FunctionCFG IROptimizer::buildCFG(const IRFunction& func) {
+    FunctionCFG cfg;
+    int n = (int)func.blocks.size();
+    std::map<std::string, int> index;
+    for (int i = 0; i < n; ++i) index[func.blocks[i].label] = i;
+    cfg.succ.resize(n);
+    cfg.pred.resize(n);
+    for (int i = 0; i < n; ++i) {
+        for (const auto& label : func.blocks[i].successors()) {
+            auto it = index.find(label);
+            if (it == index.end()) continue;
+            cfg.succ[i].push_back(it->second);
+            cfg.pred[it->second].push_back(i);
+        }
+    }
+
+    // 迭代 DFS 求后序
+    std::vector<int> post;
+    std::vector<char> visited(n, 0);
+    std::vector<std::pair<int, size_t>> stack;
+    if (n > 0) {
+        stack.push_back({0, 0});
+        visited[0] = 1;
+    }
+    while (!stack.empty()) {
+        int b = stack.back().first;
+        size_t& next = stack.back().second;
+        if (next < cfg.succ[b].size()) {
+            int s = cfg.succ[b][next++];
+            if (!visited[s]) {
+                visited[s] = 1;
+                stack.push_back({s, 0});
+            }
+        } else {
+            post.push_back(b);
+            stack.pop_back();
+        }
+    }
+    cfg.rpo.assign(post.rbegin(), post.rend());
+
+    std::vector<int> order(n, -1);
+    for (int k = 0; k < (int)cfg.rpo.size(); ++k) order[cfg.rpo[k]] = k;
+    cfg.idom.assign(n, -1);
+    if (n > 0) cfg.idom[0] = 0;
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (order[a] > order[b]) a = cfg.idom[a];
+            while (order[b] > order[a]) b = cfg.idom[b];
+        }
+        return a;
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b : cfg.rpo) {
+            if (b == 0) continue;
+            int new_idom = -1;
+            for (int p : cfg.pred[b]) {
+                if (cfg.idom[p] == -1) continue;
+                new_idom = (new_idom == -1) ? p : intersect(p, new_idom);
+            }
+            if (new_idom != cfg.idom[b]) {
+                cfg.idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    cfg.dom_children.resize(n);
+    for (int b : cfg.rpo) {
+        if (b != 0) cfg.dom_children[cfg.idom[b]].push_back(b);
+    }
+    return cfg;
+}
+
+// 按替换表改写所有操作数（替换链逐级解析）
+void IROptimizer::replaceUses(IRFunction& func, const std::map<std::string, std::string>& replacement) {
+    if (replacement.empty()) return;
+    for (auto& block : func.blocks) {
+        for (auto& inst : block.insts) {
+            for (auto& op : inst.operands) {
+                auto it = replacement.find(op);
+                while (it != replacement.end()) {
+                    op = it->second;
+                    it = replacement.find(op);
+                }
+            }
+        }
+    }
+}
+
+// 删除从入口不可达的基本块，并去掉 phi 中来自这些块的入边
+void IROptimizer::removeUnreachableBlocks(IRFunction& func) {
+    FunctionCFG cfg = buildCFG(func);
+    std::set<std::string> removed;
+    for (int i = 0; i < (int)func.blocks.size(); ++i) {
+        if (cfg.idom[i] == -1) removed.insert(func.blocks[i].label);
+    }
+    if (removed.empty()) return;
+    std::vector<IRBlock> kept;
+    for (int i = 0; i < (int)func.blocks.size(); ++i) {
+        if (cfg.idom[i] != -1) kept.push_back(std::move(func.blocks[i]));
+    }
+    func.blocks = std::move(kept);
+    for (auto& block : func.blocks) {
+        for (auto& inst : block.insts) {
+            if (inst.opcode != IROpcode::Phi) continue;
+            for (size_t k = inst.labels.size(); k-- > 0;) {
+                if (removed.count(inst.labels[k])) {
+                    inst.labels.erase(inst.labels.begin() + k);
+                    inst.operands.erase(inst.operands.begin() + k);
+                }
+            }
+        }
+    }
+}
+
+// * mem2reg：只作为 load/store 地址使用的标量 alloca 提升为 SSA 值
+// 在支配边界迭代插入 phi，再沿支配树重命名，load 替换为当前到达的值，store 删除
+void IROptimizer::promoteAllocas(IRFunction& func) {
+    // 1. 找出可提升的 alloca
+    std::map<std::string, int> var_id;
+    std::vector<std::string> var_type;
+    for (const auto& block : func.blocks) {
+        for (const auto& inst : block.insts) {
+            if (inst.opcode == IROpcode::Alloca && inst.type.find('[') == std::string::npos) {
+                var_id[inst.dest] = (int)var_type.size();
+                var_type.push_back(inst.type);
+            }
+        }
+    }
+    for (const auto& block : func.blocks) {
+        for (const auto& inst : block.insts) {
+            for (size_t k = 0; k < inst.operands.size(); ++k) {
+                if (!var_id.count(inst.operands[k])) continue;
+                bool as_address = (inst.opcode == IROpcode::Load && k == 0) ||
+                                  (inst.opcode == IROpcode::Store && k == 1);
+                if (!as_address) var_id.erase(inst.operands[k]); // 地址逃逸，不能提升
+            }
+        }
+    }
+    if (var_id.empty()) return;
+    int nv = (int)var_type.size();
+
+    FunctionCFG cfg = buildCFG(func);
+    int nb = (int)func.blocks.size();
+
+    // 2. 支配边界
+    std::vector<std::set<int>> df(nb);
+    for (int b = 0; b < nb; ++b) {
+        if (cfg.pred[b].size() < 2 || cfg.idom[b] == -1) continue;
+        for (int p : cfg.pred[b]) {
+            if (cfg.idom[p] == -1) continue;
+            for (int r = p; r != cfg.idom[b]; r = cfg.idom[r]) df[r].insert(b);
+        }
+    }
+
+    // 3. 在定义块的迭代支配边界上插入 phi
+    std::vector<std::set<int>> def_blocks(nv);
+    for (int b = 0; b < nb; ++b) {
+        for (const auto& inst : func.blocks[b].insts) {
+            if (inst.opcode == IROpcode::Store && var_id.count(inst.operands[1])) {
+                def_blocks[var_id[inst.operands[1]]].insert(b);
+            }
+        }
+    }
+    std::vector<std::vector<IRInst>> new_phis(nb);
+    std::map<std::string, int> phi_var; // phi 结果 -> 对应的 alloca 编号
+    int phi_count = 0;
+    for (int v = 0; v < nv; ++v) {
+        std::vector<int> work(def_blocks[v].begin(), def_blocks[v].end());
+        std::set<int> has_phi;
+        while (!work.empty()) {
+            int x = work.back();
+            work.pop_back();
+            for (int y : df[x]) {
+                if (!has_phi.insert(y).second) continue;
+                IRInst phi;
+                phi.opcode = IROpcode::Phi;
+                phi.type = var_type[v];
+                phi.dest = "%phi." + std::to_string(phi_count++);
+                phi_var[phi.dest] = v;
+                new_phis[y].push_back(phi);
+                if (!def_blocks[v].count(y)) work.push_back(y);
+            }
+        }
+    }
+    for (int b = 0; b < nb; ++b) {
+        auto& insts = func.blocks[b].insts;
+        insts.insert(insts.begin(), new_phis[b].begin(), new_phis[b].end());
+    }
+
+    // 4. 沿支配树重命名（显式栈，避免深递归）
+    std::vector<std::vector<std::string>> stacks(nv);
+    std::map<std::string, std::string> replacement;
+    auto resolve = [&](std::string v) {
+        auto it = replacement.find(v);
+        while (it != replacement.end()) {
+            v = it->second;
+            it = replacement.find(v);
+        }
+        return v;
+    };
+    auto current = [&](int v) { return stacks[v].empty() ? std::string("0") : stacks[v].back(); };
+    struct Frame {
+        int block;
+        bool exit;
+        std::vector<int> pushed;
+    };
+    std::vector<Frame> work;
+    work.push_back({0, false, {}});
+    while (!work.empty()) {
+        Frame frame = std::move(work.back());
+        work.pop_back();
+        if (frame.exit) {
+            for (int v : frame.pushed) stacks[v].pop_back();
+            continue;
+        }
+        std::vector<int> pushed;
+        IRBlock& block = func.blocks[frame.block];
+        std::vector<IRInst> insts;
+        for (auto& inst : block.insts) {
+            if (inst.opcode == IROpcode::Phi && phi_var.count(inst.dest)) {
+                stacks[phi_var[inst.dest]].push_back(inst.dest);
+                pushed.push_back(phi_var[inst.dest]);
+                insts.push_back(std::move(inst));
+                continue;
+            }
+            if (inst.opcode != IROpcode::Phi) {
+                for (auto& op : inst.operands) op = resolve(op);
+            }
+            if (inst.opcode == IROpcode::Load && var_id.count(inst.operands[0])) {
+                replacement[inst.dest] = current(var_id[inst.operands[0]]);
+            } else if (inst.opcode == IROpcode::Store && var_id.count(inst.operands[1])) {
+                int v = var_id[inst.operands[1]];
+                stacks[v].push_back(inst.operands[0]);
+                pushed.push_back(v);
+            } else if (inst.opcode == IROpcode::Alloca && var_id.count(inst.dest)) {
+                // 已提升的 alloca 删除
+            } else {
+                insts.push_back(std::move(inst));
+            }
+        }
+        block.insts = std::move(insts);
+
+        std::set<int> visited_succ;
+        for (int s : cfg.succ[frame.block]) {
+            if (!visited_succ.insert(s).second) continue;
+            for (auto& inst : func.blocks[s].insts) {
+                if (inst.opcode != IROpcode::Phi) break;
+                auto it = phi_var.find(inst.dest);
+                if (it == phi_var.end()) continue;
+                inst.operands.push_back(current(it->second));
+                inst.labels.push_back(block.label);
+            }
+        }
+
+        work.push_back({frame.block, true, std::move(pushed)});
+        const auto& children = cfg.dom_children[frame.block];
+        for (auto it = children.rbegin(); it != children.rend(); ++it) work.push_back({*it, false, {}});
+    }
+    replaceUses(func, replacement);
+}
+
+// 删除无用的 phi，以及所有入边取值相同（或为自身）的平凡 phi
+void IROptimizer::removeTrivialPhis(IRFunction& func) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        std::map<std::string, int> use_count;
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                for (const auto& op : inst.operands) {
+                    if (op != inst.dest) use_count[op]++;
+                }
+            }
+        }
+        std::map<std::string, std::string> replacement;
+        for (auto& block : func.blocks) {
+            std::vector<IRInst> insts;
+            for (auto& inst : block.insts) {
+                if (inst.opcode == IROpcode::Phi) {
+                    if (use_count[inst.dest] == 0) {
+                        changed = true;
+                        continue;
+                    }
+                    std::string same;
+                    bool trivial = true;
+                    for (const auto& op : inst.operands) {
+                        if (op == inst.dest || op == same) continue;
+                        if (!same.empty()) {
+                            trivial = false;
+                            break;
+                        }
+                        same = op;
+                    }
+                    if (trivial) {
+                        replacement[inst.dest] = same.empty() ? "0" : same;
+                        changed = true;
+                        continue;
+                    }
+                }
+                insts.push_back(std::move(inst));
+            }
+            block.insts = std::move(insts);
+        }
+        replaceUses(func, replacement);
+    }
+}
+
+// 关键边（前驱有多个后继、后继有多个前驱）上无法放置 phi 的拷贝，
+// 在这类边上插入只含一条跳转的中间块。
+// * 回边不拆分：后端把回边上的拷贝提前到条件分支之前，分支直接跳回循环头
+void IROptimizer::splitCriticalEdges(IRFunction& func) {
+    FunctionCFG cfg = buildCFG(func);
+    std::vector<IRBlock> blocks;
+    std::map<std::string, std::map<std::string, std::string>> retarget; // 后继 -> (前驱 -> 中间块)
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        IRBlock& block = func.blocks[b];
+        blocks.push_back(block);
+        size_t source = blocks.size() - 1;
+        if (cfg.succ[b].size() < 2) continue;
+        for (int s : cfg.succ[b]) {
+            const IRBlock& target = func.blocks[s];
+            bool has_phi = !target.insts.empty() && target.insts[0].opcode == IROpcode::Phi;
+            if (!has_phi || cfg.pred[s].size() < 2 || cfg.dominates(s, b)) continue;
+            IRBlock edge;
+            edge.label = newBlockLabel("crit_edge");
+            IRInst br;
+            br.opcode = IROpcode::Br;
+            br.labels = {target.label};
+            edge.insts.push_back(br);
+            for (auto& label : blocks[source].insts.back().labels) {
+                if (label == target.label) label = edge.label;
+            }
+            retarget[target.label][block.label] = edge.label;
+            blocks.push_back(edge);
+        }
+    }
+    if (retarget.empty()) return;
+    for (auto& block : blocks) {
+        auto it = retarget.find(block.label);
+        if (it == retarget.end()) continue;
+        for (auto& inst : block.insts) {
+            if (inst.opcode != IROpcode::Phi) break;
+            for (auto& label : inst.labels) {
+                auto edge = it->second.find(label);
+                if (edge != it->second.end()) label = edge->second;
+            }
+        }
+    }
+    func.blocks = std::move(blocks);
+}
+
+// 整个模块中从未被写入、只被 load 读取的标量全局变量，其值恒为初始值
+void IROptimizer::findConstantGlobals() {
+    constant_globals.clear();
+    for (const auto& line : module.globals) {
+        // @name = global i32 5, align 4  或  @name = constant i32 5, align 4
+        std::stringstream ss(line);
+        std::string name, assign, kind, type, value;
+        ss >> name >> assign >> kind >> type >> value;
+        if (name.empty() || name[0] != '@' || assign != "=" || type != "i32") continue;
+        if (kind != "global" && kind != "constant") continue;
+        if (!value.empty() && value.back() == ',') value.pop_back();
+        if (!isIRConstant(value)) continue;
+        constant_globals[name] = (int)std::stoll(value);
+    }
+    for (const auto& func : module.functions) {
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                for (size_t k = 0; k < inst.operands.size(); ++k) {
+                    bool is_read = inst.opcode == IROpcode::Load && k == 0;
+                    if (!is_read) constant_globals.erase(inst.operands[k]);
+                }
+            }
+        }
+    }
+}
+
+// * 稀疏条件常量传播（Wegman-Zadeck）：值格为 未定义 / 常量 / 非常量，
+// 只沿可执行的边传播；结束后常量值替换为立即数，常量条件的 br 改为无条件跳转，
+// 不可执行的块留给 removeUnreachableBlocks 删除
+void IROptimizer::propagateConstants(IRFunction& func) {
+    enum State { Undefined, Constant, Overdefined };
+    struct Lattice {
+        State state = Undefined;
+        int value = 0;
+    };
+    int nb = (int)func.blocks.size();
+    if (nb == 0) return;
+    std::map<std::string, int> index;
+    for (int b = 0; b < nb; ++b) index[func.blocks[b].label] = b;
+
+    std::map<std::string, Lattice> lattice;
+    for (const auto& param : func.params) lattice[param.second].state = Overdefined;
+    std::map<std::string, std::vector<std::pair<int, int>>> users; // 值 -> (块, 指令)
+    for (int b = 0; b < nb; ++b) {
+        const auto& insts = func.blocks[b].insts;
+        for (int i = 0; i < (int)insts.size(); ++i) {
+            for (const auto& op : insts[i].operands) {
+                if (!op.empty() && op[0] == '%') users[op].push_back({b, i});
+            }
+        }
+    }
+    auto valueOf = [&](const std::string& op) {
+        Lattice l;
+        if (isIRConstant(op)) {
+            l.state = Constant;
+            l.value = (int)(uint32_t)std::stoll(op);
+        } else if (!op.empty() && op[0] == '%') {
+            auto it = lattice.find(op);
+            if (it != lattice.end()) l = it->second;
+        } else {
+            l.state = Overdefined; // 全局地址、null 等
+        }
+        return l;
+    };
+
+    std::vector<char> executable(nb, 0);
+    std::set<std::pair<int, int>> executable_edges;
+    std::vector<std::pair<int, int>> edge_work;
+    std::vector<std::string> value_work;
+    edge_work.push_back({-1, 0});
+
+    auto update = [&](const std::string& dest, Lattice l) {
+        Lattice& cur = lattice[dest];
+        if (cur.state == Overdefined) return;
+        if (l.state == Undefined) return;
+        if (cur.state == Constant && (l.state == Overdefined || l.value != cur.value)) {
+            cur.state = Overdefined;
+        } else if (cur.state == Undefined) {
+            cur = l;
+        } else {
+            return;
+        }
+        value_work.push_back(dest);
+    };
+    auto fold = [](IROpcode opcode, const std::string& pred, int a, int b, bool& ok) {
+        ok = true;
+        uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+        switch (opcode) {
+            case IROpcode::Add: return (int)(ua + ub);
+            case IROpcode::Sub: return (int)(ua - ub);
+            case IROpcode::Mul: return (int)(ua * ub);
+            case IROpcode::SDiv:
+            case IROpcode::SRem:
+                if (b == 0) break;
+                if (a == INT32_MIN && b == -1) return opcode == IROpcode::SDiv ? a : 0;
+                return opcode == IROpcode::SDiv ? a / b : a % b;
+            case IROpcode::ICmp:
+                if (pred == "eq") return (int)(a == b);
+                if (pred == "ne") return (int)(a != b);
+                if (pred == "slt") return (int)(a < b);
+                if (pred == "sle") return (int)(a <= b);
+                if (pred == "sgt") return (int)(a > b);
+                if (pred == "sge") return (int)(a >= b);
+                if (pred == "ult") return (int)(ua < ub);
+                if (pred == "ule") return (int)(ua <= ub);
+                if (pred == "ugt") return (int)(ua > ub);
+                if (pred == "uge") return (int)(ua >= ub);
+                break;
+            default:
+                break;
+        }
+        ok = false;
+        return 0;
+    };
+    auto markEdge = [&](int from, int to) {
+        if (executable_edges.insert({from, to}).second) edge_work.push_back({from, to});
+    };
+    auto visit = [&](int b, const IRInst& inst) {
+        switch (inst.opcode) {
+            case IROpcode::Phi: {
+                Lattice result;
+                for (size_t k = 0; k < inst.operands.size(); ++k) {
+                    auto pred = index.find(inst.labels[k]);
+                    if (pred == index.end() || !executable_edges.count({pred->second, b})) continue;
+                    Lattice in = valueOf(inst.operands[k]);
+                    if (in.state == Undefined) continue;
+                    if (in.state == Overdefined || (result.state == Constant && result.value != in.value)) {
+                        result.state = Overdefined;
+                        break;
+                    }
+                    result = in;
+                }
+                update(inst.dest, result);
+                break;
+            }
+            case IROpcode::Add:
+            case IROpcode::Sub:
+            case IROpcode::Mul:
+            case IROpcode::SDiv:
+            case IROpcode::SRem:
+            case IROpcode::ICmp: {
+                Lattice a = valueOf(inst.operands[0]), c = valueOf(inst.operands[1]);
+                Lattice result;
+                if (inst.opcode == IROpcode::Mul &&
+                    ((a.state == Constant && a.value == 0) || (c.state == Constant && c.value == 0))) {
+                    result.state = Constant; // x * 0 不论 x 为何都是 0
+                } else if (a.state == Overdefined || c.state == Overdefined) {
+                    result.state = Overdefined;
+                } else if (a.state == Constant && c.state == Constant) {
+                    bool ok;
+                    result.value = fold(inst.opcode, inst.predicate, a.value, c.value, ok);
+                    result.state = ok ? Constant : Overdefined;
+                }
+                update(inst.dest, result);
+                break;
+            }
+            case IROpcode::Zext:
+                update(inst.dest, valueOf(inst.operands[0]));
+                break;
+            case IROpcode::Load: {
+                Lattice result;
+                result.state = Overdefined;
+                auto global = constant_globals.find(inst.operands[0]);
+                if (global != constant_globals.end()) {
+                    result.state = Constant;
+                    result.value = global->second;
+                }
+                update(inst.dest, result);
+                break;
+            }
+            case IROpcode::Br:
+                if (index.count(inst.labels[0])) markEdge(b, index[inst.labels[0]]);
+                break;
+            case IROpcode::CondBr: {
+                Lattice cond = valueOf(inst.operands[0]);
+                if (cond.state == Undefined) break;
+                for (int k = 0; k < 2; ++k) {
+                    bool taken = cond.state == Overdefined || (cond.value != 0) == (k == 0);
+                    if (taken && index.count(inst.labels[k])) markEdge(b, index[inst.labels[k]]);
+                }
+                break;
+            }
+            default:
+                if (!inst.dest.empty()) {
+                    Lattice result;
+                    result.state = Overdefined;
+                    update(inst.dest, result);
+                }
+                break;
+        }
+    };
+
+    while (!edge_work.empty() || !value_work.empty()) {
+        while (!edge_work.empty()) {
+            int b = edge_work.back().second;
+            edge_work.pop_back();
+            const auto& insts = func.blocks[b].insts;
+            if (executable[b]) {
+                // 新的可执行入边只影响 phi
+                for (const auto& inst : insts) {
+                    if (inst.opcode != IROpcode::Phi) break;
+                    visit(b, inst);
+                }
+                continue;
+            }
+            executable[b] = 1;
+            for (const auto& inst : insts) visit(b, inst);
+        }
+        while (!value_work.empty()) {
+            std::string v = value_work.back();
+            value_work.pop_back();
+            for (const auto& use : users[v]) {
+                if (executable[use.first]) visit(use.first, func.blocks[use.first].insts[use.second]);
+            }
+        }
+    }
+
+    // 改写：常量值替换为立即数并删除其定义，常量条件跳转只保留走到的一边
+    std::map<std::string, std::string> replacement;
+    for (const auto& item : lattice) {
+        if (item.second.state == Constant) replacement[item.first] = std::to_string(item.second.value);
+    }
+    for (int b = 0; b < nb; ++b) {
+        if (!executable[b]) continue;
+        IRBlock& block = func.blocks[b];
+        std::vector<IRInst> insts;
+        for (auto& inst : block.insts) {
+            if (!inst.dest.empty() && replacement.count(inst.dest) && inst.opcode != IROpcode::Call) continue;
+            if (inst.opcode == IROpcode::CondBr) {
+                Lattice cond = valueOf(inst.operands[0]);
+                if (cond.state == Constant) {
+                    std::string taken = inst.labels[cond.value != 0 ? 0 : 1];
+                    std::string dropped = inst.labels[cond.value != 0 ? 1 : 0];
+                    if (dropped != taken && index.count(dropped)) {
+                        for (auto& phi : func.blocks[index[dropped]].insts) {
+                            if (phi.opcode != IROpcode::Phi) break;
+                            for (size_t k = phi.labels.size(); k-- > 0;) {
+                                if (phi.labels[k] == block.label) {
+                                    phi.labels.erase(phi.labels.begin() + k);
+                                    phi.operands.erase(phi.operands.begin() + k);
+                                }
+                            }
+                        }
+                    }
+                    inst.opcode = IROpcode::Br;
+                    inst.operands.clear();
+                    inst.labels = {taken};
+                }
+            }
+            insts.push_back(std::move(inst));
+        }
+        block.insts = std::move(insts);
+    }
+    replaceUses(func, replacement);
+}
+
+// * 标记-清除式死代码删除：以 store/call/ret/br 及无法识别的指令为根，
+// 沿操作数把定义标记为有用，没有被标记的指令全部删除（死链一次性消除）。
+// 从未被读取的局部数组/变量（地址没有被 load、传给函数或作为值存储），
+// 写入它们的 store 不算根，随后 store、gep 与 alloca 一起被删除
+void IROptimizer::eliminateDeadCode(IRFunction& func) {
+    std::map<std::string, const IRInst*> def;
+    for (const auto& block : func.blocks) {
+        for (const auto& inst : block.insts) {
+            if (!inst.dest.empty()) def[inst.dest] = &inst;
+        }
+    }
+
+    // 找出只被写入的 alloca：指针沿 gep 追溯到根 alloca
+    auto rootAlloca = [&](std::string v) {
+        while (true) {
+            auto it = def.find(v);
+            if (it == def.end()) return std::string();
+            if (it->second->opcode == IROpcode::Alloca) return v;
+            if (it->second->opcode != IROpcode::GetElementPtr) return std::string();
+            v = it->second->operands[0];
+        }
+    };
+    std::set<std::string> read_allocas;
+    for (const auto& block : func.blocks) {
+        for (const auto& inst : block.insts) {
+            for (size_t k = 0; k < inst.operands.size(); ++k) {
+                bool as_address = (inst.opcode == IROpcode::Store && k == 1) ||
+                                  (inst.opcode == IROpcode::GetElementPtr && k == 0);
+                if (as_address) continue;
+                std::string root = rootAlloca(inst.operands[k]);
+                if (!root.empty()) read_allocas.insert(root);
+            }
+        }
+    }
+
+    std::set<const IRInst*> live;
+    std::vector<const IRInst*> work;
+    for (const auto& block : func.blocks) {
+        for (const auto& inst : block.insts) {
+            bool root = false;
+            switch (inst.opcode) {
+                case IROpcode::Store: {
+                    std::string target = rootAlloca(inst.operands[1]);
+                    root = target.empty() || read_allocas.count(target);
+                    break;
+                }
+                case IROpcode::Call:
+                case IROpcode::Br:
+                case IROpcode::CondBr:
+                case IROpcode::Ret:
+                case IROpcode::Unknown:
+                    root = true;
+                    break;
+                default:
+                    break;
+            }
+            if (root && live.insert(&inst).second) work.push_back(&inst);
+        }
+    }
+    while (!work.empty()) {
+        const IRInst* inst = work.back();
+        work.pop_back();
+        for (const auto& op : inst->operands) {
+            auto it = def.find(op);
+            if (it != def.end() && live.insert(it->second).second) work.push_back(it->second);
+        }
+    }
+
+    for (auto& block : func.blocks) {
+        std::vector<IRInst> insts;
+        for (auto& inst : block.insts) {
+            if (live.count(&inst)) insts.push_back(std::move(inst));
+        }
+        block.insts = std::move(insts);
+    }
+}
+
+// 为循环头建立前置块：循环外只有一个前驱时，若它只跳到循环头就直接用它，否则在这条边上插入新块。
+// 循环外有多个前驱时返回 -1（前端生成的循环不会出现）
+int IROptimizer::getPreheader(IRFunction& func, const FunctionCFG& cfg, int header, const std::set<int>& body) {
+    int outside = -1;
+    for (int p : cfg.pred[header]) {
+        if (body.count(p)) continue;
+        if (outside != -1 && outside != p) return -1;
+        outside = p;
+    }
+    if (outside == -1) return -1;
+    if (cfg.succ[outside].size() == 1) return outside;
+
+    std::string header_label = func.blocks[header].label;
+    std::string pred_label = func.blocks[outside].label;
+    IRBlock pre;
+    pre.label = newBlockLabel("preheader");
+    IRInst br;
+    br.opcode = IROpcode::Br;
+    br.labels = {header_label};
+    pre.insts.push_back(br);
+    for (auto& label : func.blocks[outside].insts.back().labels) {
+        if (label == header_label) label = pre.label;
+    }
+    for (auto& inst : func.blocks[header].insts) {
+        if (inst.opcode != IROpcode::Phi) break;
+        for (auto& label : inst.labels) {
+            if (label == pred_label) label = pre.label;
+        }
+    }
+    func.blocks.insert(func.blocks.begin() + header, pre); // 放在循环头之前，顺序落入
+    return header;
+}
+
+// 各循环头按循环体从小到大排列（内层循环在前）
+std::vector<std::string> IROptimizer::loopHeadersInnermostFirst(const IRFunction& func) {
+    std::vector<std::pair<size_t, std::string>> order; // (循环体大小, 循环头)
+    FunctionCFG cfg = buildCFG(func);
+    for (const auto& loop : cfg.naturalLoops()) {
+        order.push_back({loop.second.size(), func.blocks[loop.first].label});
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<std::string> headers;
+    for (const auto& item : order) headers.push_back(item.second);
+    return headers;
+}
+
+// 重新计算以 header_label 为头的循环（前面的变换可能改动了 CFG），并确保它有前置块
+bool IROptimizer::prepareLoop(IRFunction& func, const std::string& header_label, LoopContext& loop) {
+    loop.cfg = buildCFG(func);
+    loop.header = func.findBlock(header_label);
+    std::map<int, std::set<int>> loops = loop.cfg.naturalLoops();
+    if (loop.header < 0 || !loops.count(loop.header)) return false;
+    loop.body = loops[loop.header];
+    loop.preheader = getPreheader(func, loop.cfg, loop.header, loop.body);
+    if (loop.preheader < 0) return false;
+    if (loop.preheader == loop.header) { // 插入了新块，块下标整体后移
+        loop.cfg = buildCFG(func);
+        loop.header = func.findBlock(header_label);
+        loop.body = loop.cfg.naturalLoops()[loop.header];
+        loop.preheader = loop.header - 1;
+    }
+    return true;
+}
+
+// * 循环不变量外提（LICM）：由内向外处理每个自然循环，把操作数都在循环外定义的
+// 无副作用指令移到前置块。load 只有在循环内没有可能别名的 store/用户函数调用，
+// 且地址静态合法或所在块支配所有出口时才外提；除法只外提除数为非零常量的
+void IROptimizer::hoistLoopInvariants(IRFunction& func) {
+    for (const auto& header_label : loopHeadersInnermostFirst(func)) {
+        LoopContext loop;
+        if (!prepareLoop(func, header_label, loop)) continue;
+        const FunctionCFG& cfg = loop.cfg;
+        const std::set<int>& body = loop.body;
+        int pre = loop.preheader;
+
+        // 值 -> 定义所在块；指针值 -> 根对象（alloca / 全局 / 形参，未知为空）
+        // 定义指令按值保存操作码与操作数：外提时会从块中删除指令，指向块内指令的指针会失效
+        struct ValueDef {
+            IROpcode opcode;
+            std::vector<std::string> operands;
+        };
+        std::map<std::string, int> def_block;
+        std::map<std::string, ValueDef> def;
+        for (int b = 0; b < (int)func.blocks.size(); ++b) {
+            for (const auto& inst : func.blocks[b].insts) {
+                if (inst.dest.empty()) continue;
+                def_block[inst.dest] = b;
+                def[inst.dest] = {inst.opcode, inst.operands};
+            }
+        }
+        std::set<std::string> params;
+        for (const auto& param : func.params) params.insert(param.second);
+        auto rootOf = [&](std::string v) {
+            while (true) {
+                if (!v.empty() && v[0] == '@') return v;
+                if (params.count(v)) return v;
+                auto it = def.find(v);
+                if (it == def.end()) return std::string();
+                if (it->second.opcode == IROpcode::Alloca) return v;
+                if (it->second.opcode != IROpcode::GetElementPtr) return std::string();
+                v = it->second.operands[0];
+            }
+        };
+        auto isAlloca = [&](const std::string& root) {
+            auto it = def.find(root);
+            return it != def.end() && it->second.opcode == IROpcode::Alloca;
+        };
+        auto mayAlias = [&](const std::string& a, const std::string& b) {
+            if (a.empty() || b.empty()) return true;
+            if (isAlloca(a) || isAlloca(b)) return a == b; // 形参与全局不会指向本函数的栈
+            if (a[0] == '@' && b[0] == '@') return a == b;
+            return true;
+        };
+        // 传给函数的 alloca 可能被被调函数改写
+        std::set<std::string> escaped;
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                if (inst.opcode != IROpcode::Call) continue;
+                for (const auto& op : inst.operands) {
+                    std::string root = rootOf(op);
+                    if (!root.empty()) escaped.insert(root);
+                }
+            }
+        }
+        std::vector<std::string> store_roots;
+        bool has_call = false;
+        for (int b : body) {
+            for (const auto& inst : func.blocks[b].insts) {
+                if (inst.opcode == IROpcode::Store) store_roots.push_back(rootOf(inst.operands[1]));
+                if (inst.opcode == IROpcode::Call && !isBuiltinFunction(inst.callee)) has_call = true;
+            }
+        }
+        std::vector<int> exiting;
+        for (int b : body) {
+            for (int s : cfg.succ[b]) {
+                if (!body.count(s)) exiting.push_back(b);
+            }
+        }
+        // 地址静态合法：全局/alloca 本身，或全部为常量下标的 gep
+        auto staticAddress = [&](std::string v) {
+            while (true) {
+                if (!v.empty() && v[0] == '@') return true;
+                auto it = def.find(v);
+                if (it == def.end()) return false;
+                if (it->second.opcode == IROpcode::Alloca) return true;
+                if (it->second.opcode != IROpcode::GetElementPtr) return false;
+                for (size_t k = 1; k < it->second.operands.size(); ++k) {
+                    if (!isIRConstant(it->second.operands[k])) return false;
+                }
+                v = it->second.operands[0];
+            }
+        };
+
+        std::set<std::string> hoisted;
+        auto invariant = [&](const std::string& op) {
+            if (hoisted.count(op)) return true;
+            auto it = def_block.find(op);
+            return it == def_block.end() || !body.count(it->second);
+        };
+        auto canHoist = [&](int b, const IRInst& inst) {
+            switch (inst.opcode) {
+                case IROpcode::Add: case IROpcode::Sub: case IROpcode::Mul:
+                case IROpcode::ICmp: case IROpcode::Zext: case IROpcode::GetElementPtr:
+                    break;
+                case IROpcode::SDiv: case IROpcode::SRem:
+                    if (!isIRConstant(inst.operands[1]) || std::stoll(inst.operands[1]) == 0) return false;
+                    break;
+                case IROpcode::Load: {
+                    std::string root = rootOf(inst.operands[0]);
+                    for (const auto& store_root : store_roots) {
+                        if (mayAlias(root, store_root)) return false;
+                    }
+                    if (has_call && (root.empty() || !isAlloca(root) || escaped.count(root))) return false;
+                    bool dominates_exits = true;
+                    for (int e : exiting) dominates_exits = dominates_exits && cfg.dominates(b, e);
+                    if (!dominates_exits && !staticAddress(inst.operands[0])) return false;
+                    break;
+                }
+                default:
+                    return false;
+            }
+            for (const auto& op : inst.operands) {
+                if (!invariant(op)) return false;
+            }
+            return true;
+        };
+
+        std::vector<IRInst> moved;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int b : cfg.rpo) {
+                if (!body.count(b)) continue;
+                auto& insts = func.blocks[b].insts;
+                for (size_t i = 0; i < insts.size();) {
+                    if (canHoist(b, insts[i])) {
+                        hoisted.insert(insts[i].dest);
+                        moved.push_back(std::move(insts[i]));
+                        insts.erase(insts.begin() + i);
+                        changed = true;
+                    } else {
+                        ++i;
+                    }
+                }
+            }
+        }
+        auto& pre_insts = func.blocks[pre].insts;
+        pre_insts.insert(pre_insts.end() - 1, moved.begin(), moved.end());
+    }
+}
+
+// 构造一条二元运算指令
+static IRInst makeBinary(IROpcode opcode, const std::string& dest, const std::string& a, const std::string& b) {
+    IRInst inst;
+    inst.opcode = opcode;
+    inst.dest = dest;
+    inst.type = "i32";
+    inst.operands = {a, b};
+    return inst;
+}
+
+// 构造 getelementptr inbounds i32, i32* base, i32 index
+static IRInst makeElementPtr(const std::string& dest, const std::string& base, const std::string& index) {
+    IRInst inst;
+    inst.opcode = IROpcode::GetElementPtr;
+    inst.dest = dest;
+    inst.type = "i32";
+    inst.operands = {base, index};
+    return inst;
+}
+
+// * 归纳变量强度削弱：循环头中形如 i = phi [init, 前置块], [i + c, 回边] 的基本归纳变量，
+// 循环内下标为 a * i + b（b 为循环不变量）的 getelementptr i32 改为指针归纳变量
+// p = phi [&base[a * init + b], 前置块], [p + a * c, 回边]，每次迭代只需一条 addiu。
+// 若 i 之后只剩自增与循环头的比较，把比较改写为 p 与 &base[a * N + b] 的比较，i 随后被 DCE 删除
+void IROptimizer::reduceInductionVariables(IRFunction& func) {
+    struct Affine {
+        std::string iv;    // 基本归纳变量（phi）
+        long long a = 0;   // i 的系数
+        std::string b_val; // 不变量部分（空表示没有）
+        long long b_const = 0;
+    };
+    for (const auto& header_label : loopHeadersInnermostFirst(func)) {
+        LoopContext loop;
+        if (!prepareLoop(func, header_label, loop)) continue;
+        const std::set<int>& body = loop.body;
+        IRBlock& header = func.blocks[loop.header];
+        std::string pre_label = func.blocks[loop.preheader].label;
+
+        std::map<std::string, int> def_block;
+        std::map<std::string, IRInst*> def;
+        for (int b = 0; b < (int)func.blocks.size(); ++b) {
+            for (auto& inst : func.blocks[b].insts) {
+                if (inst.dest.empty()) continue;
+                def_block[inst.dest] = b;
+                def[inst.dest] = &inst;
+            }
+        }
+        auto invariant = [&](const std::string& v) {
+            auto it = def_block.find(v);
+            return it == def_block.end() || !body.count(it->second);
+        };
+
+        // 1. 基本归纳变量：phi 结果 -> (初值, 步长, 自增值, 回边块)
+        struct BasicIV {
+            std::string init, next, latch;
+            long long step;
+        };
+        std::map<std::string, BasicIV> ivs;
+        for (const auto& inst : header.insts) {
+            if (inst.opcode != IROpcode::Phi) break;
+            if (inst.operands.size() != 2 || inst.type != "i32") continue;
+            int in = inst.labels[0] == pre_label ? 0 : (inst.labels[1] == pre_label ? 1 : -1);
+            if (in < 0) continue;
+            const std::string& next = inst.operands[1 - in];
+            auto it = def.find(next);
+            if (it == def.end() || !body.count(def_block[next])) continue;
+            const IRInst& inc = *it->second;
+            long long step;
+            if (inc.opcode == IROpcode::Add && inc.operands[0] == inst.dest && isIRConstant(inc.operands[1])) {
+                step = std::stoll(inc.operands[1]);
+            } else if (inc.opcode == IROpcode::Add && inc.operands[1] == inst.dest && isIRConstant(inc.operands[0])) {
+                step = std::stoll(inc.operands[0]);
+            } else if (inc.opcode == IROpcode::Sub && inc.operands[0] == inst.dest && isIRConstant(inc.operands[1])) {
+                step = -std::stoll(inc.operands[1]);
+            } else {
+                continue;
+            }
+            ivs[inst.dest] = {inst.operands[in], next, inst.labels[1 - in], step};
+        }
+        if (ivs.empty()) continue;
+
+        // 2. 下标的仿射形式 a * i + b
+        std::map<std::string, Affine> affine_cache;
+        std::function<bool(const std::string&, Affine&)> affineOf = [&](const std::string& v, Affine& out) {
+            if (ivs.count(v)) {
+                out = Affine();
+                out.iv = v;
+                out.a = 1;
+                return true;
+            }
+            auto cached = affine_cache.find(v);
+            if (cached != affine_cache.end()) {
+                out = cached->second;
+                return !out.iv.empty();
+            }
+            affine_cache[v] = Affine(); // 防止沿 phi 环递归
+            auto it = def.find(v);
+            if (it == def.end() || invariant(v)) return false;
+            const IRInst& inst = *it->second;
+            Affine result;
+            bool ok = false;
+            if (inst.opcode == IROpcode::Add || inst.opcode == IROpcode::Sub) {
+                Affine x, y;
+                bool fx = affineOf(inst.operands[0], x), fy = affineOf(inst.operands[1], y);
+                bool is_sub = inst.opcode == IROpcode::Sub;
+                auto addInvariant = [&](Affine& acc, const std::string& term) {
+                    if (isIRConstant(term)) {
+                        acc.b_const += is_sub ? -std::stoll(term) : std::stoll(term);
+                        return true;
+                    }
+                    if (is_sub || !acc.b_val.empty() || !invariant(term)) return false;
+                    acc.b_val = term;
+                    return true;
+                };
+                if (fx && !fy) {
+                    result = x;
+                    ok = addInvariant(result, inst.operands[1]);
+                } else if (!fx && fy && !is_sub) {
+                    result = y;
+                    ok = addInvariant(result, inst.operands[0]);
+                } else if (fx && fy && x.iv == y.iv && (x.b_val.empty() || y.b_val.empty())) {
+                    result = x;
+                    result.a = is_sub ? x.a - y.a : x.a + y.a;
+                    result.b_const = is_sub ? x.b_const - y.b_const : x.b_const + y.b_const;
+                    if (!y.b_val.empty()) {
+                        ok = !is_sub;
+                        result.b_val = y.b_val;
+                    } else {
+                        ok = true;
+                    }
+                }
+            } else if (inst.opcode == IROpcode::Mul) {
+                Affine x;
+                std::string k;
+                if (isIRConstant(inst.operands[1]) && affineOf(inst.operands[0], x)) k = inst.operands[1];
+                else if (isIRConstant(inst.operands[0]) && affineOf(inst.operands[1], x)) k = inst.operands[0];
+                if (!k.empty() && x.b_val.empty()) {
+                    result = x;
+                    result.a *= std::stoll(k);
+                    result.b_const *= std::stoll(k);
+                    ok = true;
+                }
+            }
+            if (ok && result.a == 0) ok = false;
+            if (!ok) result = Affine();
+            affine_cache[v] = result;
+            out = result;
+            return ok;
+        };
+
+        // 3. 为每个 (base, a, b) 建立指针归纳变量
+        struct PointerIV {
+            std::string phi, start, next, base;
+            Affine form;
+            long long lo = 1, hi = 0; // base 可合法指向的下标范围 [lo, hi]（含尾后位置），未知时 lo > hi
+        };
+        // base 为 getelementptr [N x i32], [N x i32]* arr, i32 0, i32 k 时，下标范围为 [-k, N - k]
+        auto arrayExtent = [&](const std::string& base, long long& lo, long long& hi) {
+            auto it = def.find(base);
+            if (it == def.end()) return;
+            const IRInst& gep = *it->second;
+            if (gep.opcode != IROpcode::GetElementPtr || gep.operands.size() != 3 || gep.operands[1] != "0" ||
+                !isIRConstant(gep.operands[2]) || gep.type.size() <= 6 || gep.type[0] != '[' ||
+                gep.type.compare(gep.type.size() - 6, 6, "x i32]") != 0) return;
+            long long k = std::stoll(gep.operands[2]);
+            lo = -k;
+            hi = std::stoll(gep.type.substr(1)) - k;
+        };
+        std::map<std::tuple<std::string, std::string, long long, std::string, long long>, PointerIV> pointer_ivs;
+        std::vector<IRInst> pre_insts;
+        std::map<std::string, std::string> replacement;
+        // 在前置块中计算 a * x + b（x 为常量或不变量）
+        auto emitIndex = [&](const Affine& form, const std::string& x) {
+            if (isIRConstant(x)) {
+                std::string c = std::to_string((int32_t)(uint32_t)(form.a * std::stoll(x) + form.b_const));
+                if (form.b_val.empty()) return c;
+                if (c == "0") return form.b_val;
+                std::string sum = newValueName("lsr");
+                pre_insts.push_back(makeBinary(IROpcode::Add, sum, form.b_val, c));
+                return sum;
+            }
+            std::string cur = x;
+            if (form.a != 1) {
+                std::string scaled = newValueName("lsr");
+                pre_insts.push_back(makeBinary(IROpcode::Mul, scaled, cur, std::to_string(form.a)));
+                cur = scaled;
+            }
+            if (form.b_const != 0) {
+                std::string sum = newValueName("lsr");
+                pre_insts.push_back(makeBinary(IROpcode::Add, sum, cur, std::to_string(form.b_const)));
+                cur = sum;
+            }
+            if (!form.b_val.empty()) {
+                std::string sum = newValueName("lsr");
+                pre_insts.push_back(makeBinary(IROpcode::Add, sum, cur, form.b_val));
+                cur = sum;
+            }
+            return cur;
+        };
+        std::map<std::string, std::vector<IRInst>> after_increment; // 自增值 -> 紧随其后插入的指针步进
+        std::vector<IRInst> new_phis;
+        for (int b : body) {
+            for (const auto& inst : func.blocks[b].insts) {
+                if (inst.opcode != IROpcode::GetElementPtr || inst.type != "i32" || inst.operands.size() != 2) continue;
+                if (!invariant(inst.operands[0])) continue;
+                Affine form;
+                if (!affineOf(inst.operands[1], form)) continue;
+                const BasicIV& iv = ivs[form.iv];
+                long long stride = form.a * iv.step;
+                if (stride <= -8192 || stride >= 8192) continue;
+                auto key = std::make_tuple(inst.operands[0], form.iv, form.a, form.b_val, form.b_const);
+                auto found = pointer_ivs.find(key);
+                if (found == pointer_ivs.end()) {
+                    PointerIV piv;
+                    piv.phi = newValueName("lsr");
+                    piv.start = piv.phi + ".start";
+                    piv.next = piv.phi + ".next";
+                    piv.base = inst.operands[0];
+                    piv.form = form;
+                    arrayExtent(piv.base, piv.lo, piv.hi);
+                    std::string start_index = emitIndex(form, iv.init);
+                    if (start_index == "0") piv.start = piv.base; // &base[0] 就是 base
+                    else pre_insts.push_back(makeElementPtr(piv.start, piv.base, start_index));
+                    IRInst phi;
+                    phi.opcode = IROpcode::Phi;
+                    phi.dest = piv.phi;
+                    phi.type = "i32*";
+                    phi.operands = {piv.start, piv.next};
+                    phi.labels = {pre_label, iv.latch};
+                    new_phis.push_back(phi);
+                    after_increment[iv.next].push_back(makeElementPtr(piv.next, piv.phi, std::to_string(stride)));
+                    found = pointer_ivs.emplace(key, piv).first;
+                }
+                replacement[inst.dest] = found->second.phi;
+            }
+        }
+        if (pointer_ivs.empty()) continue;
+
+        // 4. 插入新指令，删除被替换的 gep
+        for (int b : body) {
+            std::vector<IRInst> insts;
+            for (auto& inst : func.blocks[b].insts) {
+                if (!inst.dest.empty() && replacement.count(inst.dest)) continue;
+                bool is_increment = after_increment.count(inst.dest) > 0;
+                std::string dest = inst.dest;
+                insts.push_back(std::move(inst));
+                if (is_increment) {
+                    for (auto& step : after_increment[dest]) insts.push_back(step);
+                }
+            }
+            func.blocks[b].insts = std::move(insts);
+        }
+        header.insts.insert(header.insts.begin(), new_phis.begin(), new_phis.end());
+        replaceUses(func, replacement);
+        auto& pre_block = func.blocks[loop.preheader].insts;
+        pre_block.insert(pre_block.end() - 1, pre_insts.begin(), pre_insts.end());
+        pre_insts.clear();
+
+        // 5. 改写循环条件：i 只剩自增与比较两处使用时，比较改用指针归纳变量
+        // 指针按无符号比较，只有初值与终值对应的地址都落在数组范围内（不会回绕）时才与原来的有符号比较等价
+        eliminateDeadCode(func); // 先删掉原来只为计算下标服务的指令
+        std::map<std::string, int> use_count;
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                for (const auto& op : inst.operands) use_count[op]++;
+            }
+        }
+        IRInst& term = header.insts.back();
+        if (term.opcode == IROpcode::CondBr) {
+            IRInst* cmp = nullptr;
+            for (auto& inst : header.insts) {
+                if (inst.dest == term.operands[0] && inst.opcode == IROpcode::ICmp && inst.type == "i32") cmp = &inst;
+            }
+            if (cmp && use_count[cmp->dest] == 1) {
+                int side = ivs.count(cmp->operands[0]) ? 0 : (ivs.count(cmp->operands[1]) ? 1 : -1);
+                std::string iv_name = side >= 0 ? cmp->operands[side] : "";
+                const PointerIV* piv = nullptr;
+                for (const auto& item : pointer_ivs) {
+                    if (item.second.form.iv == iv_name) {
+                        piv = &item.second;
+                        break;
+                    }
+                }
+                auto inExtent = [&](const std::string& x) {
+                    if (!isIRConstant(x) || !piv->form.b_val.empty()) return false;
+                    long long index = piv->form.a * std::stoll(x) + piv->form.b_const;
+                    return piv->lo <= index && index <= piv->hi;
+                };
+                if (piv && inExtent(ivs[iv_name].init) && inExtent(cmp->operands[1 - side]) &&
+                    use_count[iv_name] == 2 && use_count[ivs[iv_name].next] == 1) {
+                    std::string end = newValueName("lsr");
+                    pre_insts.push_back(makeElementPtr(end, piv->base, emitIndex(piv->form, cmp->operands[1 - side])));
+                    pre_block.insert(pre_block.end() - 1, pre_insts.begin(), pre_insts.end());
+                    cmp->operands[side] = piv->phi;
+                    cmp->operands[1 - side] = end;
+                    cmp->type = "i32*";
+                    // 指针按无符号比较；p 随 i 递减时比较方向相反
+                    static const std::map<std::string, std::string> as_pointer = {
+                        {"eq", "eq"}, {"ne", "ne"}, {"slt", "ult"}, {"sgt", "ugt"}, {"sle", "ule"}, {"sge", "uge"}};
+                    static const std::map<std::string, std::string> mirror = {
+                        {"eq", "eq"}, {"ne", "ne"}, {"slt", "sgt"}, {"sgt", "slt"}, {"sle", "sge"}, {"sge", "sle"}};
+                    cmp->predicate = as_pointer.at(piv->form.a < 0 ? mirror.at(cmp->predicate) : cmp->predicate);
+                }
+            }
+        }
+    }
+}
+
+// * 循环旋转：把循环头的条件测试复制到前置块（入口保护，不满足时直接跳到出口）与回边块末尾
+// （底部测试，满足时跳回循环头），循环头只剩 phi，每次迭代省去回边上跳回循环头的无条件跳转。
+// 要求循环头只有 phi、无副作用的条件计算和一端出循环的条件跳转，只有一个以无条件跳转
+// 回到循环头的回边块，且出口块的前驱都在循环内。循环后对循环头 phi 的使用改为出口块中新建的 phi
+void IROptimizer::rotateLoops(IRFunction& func) {
+    for (const auto& header_label : loopHeadersInnermostFirst(func)) {
+        LoopContext loop;
+        if (!prepareLoop(func, header_label, loop)) continue;
+        const FunctionCFG& cfg = loop.cfg;
+        const std::set<int>& body = loop.body;
+        IRBlock& header = func.blocks[loop.header];
+        const IRInst& term = header.insts.back();
+        if (term.opcode != IROpcode::CondBr) continue;
+        int target0 = func.findBlock(term.labels[0]), target1 = func.findBlock(term.labels[1]);
+        if (target0 < 0 || target1 < 0 || body.count(target0) == body.count(target1)) continue;
+        int exit = body.count(target0) ? target1 : target0;
+        std::string inner_label = body.count(target0) ? term.labels[0] : term.labels[1];
+        int latch = -1;
+        bool ok = true;
+        for (int p : cfg.pred[loop.header]) {
+            if (!body.count(p)) continue;
+            ok = ok && latch == -1;
+            latch = p;
+        }
+        if (!ok || latch < 0 || func.blocks[latch].insts.back().opcode != IROpcode::Br) continue;
+        for (int p : cfg.pred[exit]) ok = ok && body.count(p);
+
+        size_t first = 0; // 第一条非 phi 指令
+        while (header.insts[first].opcode == IROpcode::Phi) ++first;
+        std::set<std::string> tests;
+        for (size_t k = first; k + 1 < header.insts.size(); ++k) {
+            switch (header.insts[k].opcode) {
+                case IROpcode::Add: case IROpcode::Sub: case IROpcode::Mul: case IROpcode::SDiv:
+                case IROpcode::SRem: case IROpcode::ICmp: case IROpcode::Zext:
+                case IROpcode::GetElementPtr: case IROpcode::Load:
+                    tests.insert(header.insts[k].dest);
+                    break;
+                default:
+                    ok = false;
+            }
+        }
+        // 条件计算的结果只能在循环头内或出口 phi 的循环头入边上使用
+        for (int b = 0; b < (int)func.blocks.size() && ok; ++b) {
+            if (b == loop.header) continue;
+            for (const auto& inst : func.blocks[b].insts) {
+                for (size_t k = 0; k < inst.operands.size(); ++k) {
+                    if (!tests.count(inst.operands[k])) continue;
+                    bool exit_phi = b == exit && inst.opcode == IROpcode::Phi && inst.labels[k] == header_label;
+                    ok = ok && exit_phi;
+                }
+            }
+        }
+        if (!ok) continue;
+
+        // 复制条件测试到 from 块末尾：循环头 phi 取 from 入边上的值，循环内目标改为循环头
+        std::string pre_label = func.blocks[loop.preheader].label;
+        std::string latch_label = func.blocks[latch].label;
+        auto cloneTest = [&](int from, std::map<std::string, std::string>& value_map) {
+            const std::string& from_label = func.blocks[from].label;
+            for (size_t k = 0; k < first; ++k) {
+                const IRInst& phi = header.insts[k];
+                for (size_t j = 0; j < phi.labels.size(); ++j) {
+                    if (phi.labels[j] == from_label) value_map[phi.dest] = phi.operands[j];
+                }
+            }
+            std::vector<IRInst> code;
+            for (size_t k = first; k < header.insts.size(); ++k) {
+                IRInst inst = header.insts[k];
+                for (auto& op : inst.operands) {
+                    auto it = value_map.find(op);
+                    if (it != value_map.end()) op = it->second;
+                }
+                if (!inst.dest.empty()) {
+                    std::string name = newValueName("rot");
+                    value_map[inst.dest] = name;
+                    inst.dest = name;
+                }
+                for (auto& label : inst.labels) {
+                    if (label == inner_label) label = header_label;
+                }
+                code.push_back(inst);
+            }
+            auto& insts = func.blocks[from].insts;
+            insts.pop_back();
+            insts.insert(insts.end(), code.begin(), code.end());
+        };
+        std::map<std::string, std::string> pre_map, latch_map;
+        cloneTest(loop.preheader, pre_map);
+        cloneTest(latch, latch_map);
+        auto mapped = [](const std::map<std::string, std::string>& value_map, const std::string& v) {
+            auto it = value_map.find(v);
+            return it == value_map.end() ? v : it->second;
+        };
+
+        // 出口块原有 phi 的循环头入边拆成前置块与回边块两条入边
+        IRBlock& exit_block = func.blocks[exit];
+        for (auto& inst : exit_block.insts) {
+            if (inst.opcode != IROpcode::Phi) break;
+            for (size_t k = 0; k < inst.labels.size(); ++k) {
+                if (inst.labels[k] != header_label) continue;
+                std::string v = inst.operands[k];
+                inst.operands[k] = mapped(pre_map, v);
+                inst.labels[k] = pre_label;
+                inst.operands.push_back(mapped(latch_map, v));
+                inst.labels.push_back(latch_label);
+                break;
+            }
+        }
+
+        // 出口支配的区域中使用的循环头 phi 改为使用出口块中的新 phi
+        std::vector<IRInst> exit_phis;
+        for (size_t k = 0; k < first; ++k) {
+            const IRInst& phi = header.insts[k];
+            std::string exit_value = newValueName("rot");
+            bool used = false;
+            for (int b = 0; b < (int)func.blocks.size(); ++b) {
+                for (auto& inst : func.blocks[b].insts) {
+                    for (size_t j = 0; j < inst.operands.size(); ++j) {
+                        if (inst.operands[j] != phi.dest) continue;
+                        // phi 的入边值在对应前驱块末尾使用
+                        int use_block = inst.opcode == IROpcode::Phi ? func.findBlock(inst.labels[j]) : b;
+                        if (!cfg.dominates(exit, use_block)) continue;
+                        inst.operands[j] = exit_value;
+                        used = true;
+                    }
+                }
+            }
+            if (!used) continue;
+            IRInst exit_phi;
+            exit_phi.opcode = IROpcode::Phi;
+            exit_phi.dest = exit_value;
+            exit_phi.type = phi.type;
+            for (int p : cfg.pred[exit]) {
+                if (p == loop.header) continue;
+                exit_phi.operands.push_back(phi.dest);
+                exit_phi.labels.push_back(func.blocks[p].label);
+            }
+            exit_phi.operands.push_back(mapped(pre_map, phi.dest));
+            exit_phi.labels.push_back(pre_label);
+            exit_phi.operands.push_back(mapped(latch_map, phi.dest));
+            exit_phi.labels.push_back(latch_label);
+            exit_phis.push_back(exit_phi);
+        }
+        exit_block.insts.insert(exit_block.insts.begin(), exit_phis.begin(), exit_phis.end());
+
+        // 循环头只保留 phi，直接进入循环体
+        header.insts.erase(header.insts.begin() + first, header.insts.end());
+        IRInst br;
+        br.opcode = IROpcode::Br;
+        br.labels = {inner_label};
+        header.insts.push_back(br);
+    }
+}
+
+// * 循环展开：循环头只有 phi、一条比较和一端出循环的条件跳转，循环只从循环头退出，
+// 归纳变量 i = phi [常量, 前置块], [i ± c, 回边]（或指针 p = phi [&a[k], 前置块], [p + c, 回边]）
+// 与常量（或同一数组上的常量偏移）比较时，按比较逐次模拟出迭代次数 T。
+// 循环体（循环头以外的块）共 S 条指令：T * S 不超过 unroll_budget 时完全展开；
+// 否则循环内复制 U = min(unroll_budget / S, MAX_UNROLL_FACTOR) 份循环体，每 U 次迭代才比较跳转一次，
+// 余下的 T % U 次迭代在进入循环前顺序执行
+void IROptimizer::unrollLoops(IRFunction& func) {
+    if (unroll_budget <= 0) return;
+    for (const auto& header_label : loopHeadersInnermostFirst(func)) {
+        LoopContext loop;
+        if (!prepareLoop(func, header_label, loop)) continue;
+        const FunctionCFG& cfg = loop.cfg;
+        const std::set<int>& body = loop.body;
+        IRBlock& header = func.blocks[loop.header];
+        std::string pre_label = func.blocks[loop.preheader].label;
+
+        // 循环头：phi..., icmp, br
+        size_t first = 0;
+        while (header.insts[first].opcode == IROpcode::Phi) ++first;
+        if (header.insts.size() != first + 2) continue;
+        const IRInst& cmp = header.insts[first];
+        const IRInst& term = header.insts[first + 1];
+        if (cmp.opcode != IROpcode::ICmp || term.opcode != IROpcode::CondBr || term.operands[0] != cmp.dest) continue;
+        int target0 = func.findBlock(term.labels[0]), target1 = func.findBlock(term.labels[1]);
+        if (target0 < 0 || target1 < 0 || body.count(target0) == body.count(target1)) continue;
+        bool body_on_true = body.count(target0) > 0;
+        int exit = body_on_true ? target1 : target0;
+        int inner = body_on_true ? target0 : target1;
+        if (inner == loop.header || cfg.pred[exit].size() != 1) continue;
+
+        // 循环体只在内部跳转（回边除外），只有一个以无条件跳转回到循环头的回边块
+        std::vector<int> body_blocks = {inner};
+        int latch = -1, size = 0;
+        bool ok = func.blocks[inner].insts[0].opcode != IROpcode::Phi;
+        for (int b : body) {
+            if (b == loop.header) continue;
+            if (b != inner) body_blocks.push_back(b);
+            for (int s : cfg.succ[b]) {
+                if (s == loop.header) {
+                    ok = ok && latch == -1 && func.blocks[b].insts.back().opcode == IROpcode::Br;
+                    latch = b;
+                } else {
+                    ok = ok && body.count(s);
+                }
+            }
+            for (const auto& inst : func.blocks[b].insts) {
+                ok = ok && inst.opcode != IROpcode::Unknown && inst.opcode != IROpcode::Alloca;
+                ++size;
+            }
+        }
+        if (!ok || latch < 0) continue;
+        for (int b = 0; b < (int)func.blocks.size() && ok; ++b) {
+            if (b == loop.header) continue;
+            for (const auto& inst : func.blocks[b].insts) {
+                ok = ok && std::find(inst.operands.begin(), inst.operands.end(), cmp.dest) == inst.operands.end();
+            }
+        }
+        if (!ok) continue;
+
+        // 循环头 phi 在两条入边上的值
+        std::string latch_label = func.blocks[latch].label;
+        std::map<std::string, std::string> entry_values, back_values;
+        for (size_t k = 0; k < first && ok; ++k) {
+            const IRInst& phi = header.insts[k];
+            ok = phi.labels.size() == 2;
+            for (size_t j = 0; j < phi.labels.size(); ++j) {
+                if (phi.labels[j] == pre_label) entry_values[phi.dest] = phi.operands[j];
+                if (phi.labels[j] == latch_label) back_values[phi.dest] = phi.operands[j];
+            }
+        }
+        if (!ok || entry_values.size() != first || back_values.size() != first) continue;
+
+        // 值表示为 锚点 + 常量偏移：整数常量的锚点为空，指针沿常量下标的 gep 找到数组
+        std::map<std::string, const IRInst*> def;
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                if (!inst.dest.empty()) def[inst.dest] = &inst;
+            }
+        }
+        auto offsetOf = [&](std::string v, std::string& anchor, long long& offset) {
+            offset = 0;
+            while (!isIRConstant(v)) {
+                auto it = def.find(v);
+                const IRInst* inst = it == def.end() ? nullptr : it->second;
+                bool element_gep = inst && inst->opcode == IROpcode::GetElementPtr;
+                if (element_gep && inst->type == "i32" && inst->operands.size() == 2 &&
+                    isIRConstant(inst->operands[1])) {
+                    offset += std::stoll(inst->operands[1]);
+                } else if (element_gep && inst->operands.size() == 3 && inst->operands[1] == "0" &&
+                           isIRConstant(inst->operands[2]) && inst->type.size() > 6 &&
+                           inst->type.compare(inst->type.size() - 6, 6, "x i32]") == 0) {
+                    offset += std::stoll(inst->operands[2]);
+                } else {
+                    anchor = v;
+                    return;
+                }
+                v = inst->operands[0];
+            }
+            anchor.clear();
+            offset += std::stoll(v);
+        };
+        int side = entry_values.count(cmp.operands[0]) ? 0 : (entry_values.count(cmp.operands[1]) ? 1 : -1);
+        if (side < 0) continue;
+        std::string iv = cmp.operands[side];
+        auto next = def.find(back_values[iv]);
+        if (next == def.end()) continue;
+        const IRInst& step_inst = *next->second;
+        long long step = 0;
+        bool int_step = (step_inst.opcode == IROpcode::Add || step_inst.opcode == IROpcode::Sub) &&
+                        step_inst.operands[0] == iv && isIRConstant(step_inst.operands[1]);
+        bool ptr_step = step_inst.opcode == IROpcode::GetElementPtr && step_inst.type == "i32" &&
+                        step_inst.operands.size() == 2 && step_inst.operands[0] == iv &&
+                        isIRConstant(step_inst.operands[1]);
+        if (step_inst.opcode == IROpcode::Add && step_inst.operands[1] == iv && isIRConstant(step_inst.operands[0])) {
+            step = std::stoll(step_inst.operands[0]);
+        } else if (int_step || ptr_step) {
+            step = std::stoll(step_inst.operands[1]);
+            if (step_inst.opcode == IROpcode::Sub) step = -step;
+        } else {
+            continue;
+        }
+        std::string start_anchor, end_anchor;
+        long long value = 0, end = 0;
+        offsetOf(entry_values[iv], start_anchor, value);
+        offsetOf(cmp.operands[1 - side], end_anchor, end);
+        bool pointer = !start_anchor.empty();
+        if (start_anchor != end_anchor || pointer != (cmp.type == "i32*")) continue;
+
+        auto holds = [&](long long a, long long b) {
+            const std::string& pred = cmp.predicate;
+            if (!pointer && pred[0] == 'u') { // 整数的无符号比较
+                a = (uint32_t)a;
+                b = (uint32_t)b;
+            }
+            if (pred == "eq") return a == b;
+            if (pred == "ne") return a != b;
+            if (pred == "slt" || pred == "ult") return a < b;
+            if (pred == "sgt" || pred == "ugt") return a > b;
+            if (pred == "sle" || pred == "ule") return a <= b;
+            return a >= b;
+        };
+        int trips = 0;
+        while (holds(side == 0 ? value : end, side == 0 ? end : value) == body_on_true && trips <= MAX_UNROLL_TRIPS) {
+            ++trips;
+            value = pointer ? value + step : (int32_t)(uint32_t)(value + step);
+        }
+        if (trips > MAX_UNROLL_TRIPS) continue;
+        int factor = 0;
+        if ((long long)trips * size > unroll_budget) {
+            factor = std::min(unroll_budget / size, MAX_UNROLL_FACTOR);
+            if (factor < 2 || trips < 2 * factor) continue;
+        }
+
+        // 复制一份循环体：phi_values 为本次迭代开始时循环头 phi 的值，复制后更新为下一次迭代的值。
+        // 复制块的回边暂时仍跳到循环头，由调用方改为下一份的入口
+        size_t latch_pos = std::find(body_blocks.begin(), body_blocks.end(), latch) - body_blocks.begin();
+        auto cloneBody = [&](std::map<std::string, std::string>& phi_values) {
+            std::map<std::string, std::string> labels, values = phi_values;
+            for (int b : body_blocks) {
+                labels[func.blocks[b].label] = newBlockLabel("unroll");
+                for (const auto& inst : func.blocks[b].insts) {
+                    if (!inst.dest.empty()) values[inst.dest] = newValueName("unroll");
+                }
+            }
+            std::vector<IRBlock> copy;
+            for (int b : body_blocks) {
+                IRBlock block;
+                block.label = labels[func.blocks[b].label];
+                for (IRInst inst : func.blocks[b].insts) {
+                    if (!inst.dest.empty()) inst.dest = values[inst.dest];
+                    for (auto& op : inst.operands) {
+                        auto it = values.find(op);
+                        if (it != values.end()) op = it->second;
+                    }
+                    for (auto& label : inst.labels) {
+                        auto it = labels.find(label);
+                        if (it != labels.end()) label = it->second;
+                    }
+                    block.insts.push_back(inst);
+                }
+                copy.push_back(block);
+            }
+            for (auto& item : phi_values) {
+                auto it = values.find(back_values[item.first]);
+                item.second = it != values.end() ? it->second : back_values[item.first];
+            }
+            return copy;
+        };
+        // 依次复制 count 份并首尾相连，最后一份的回边仍跳到循环头
+        auto cloneChain = [&](int count, std::map<std::string, std::string>& phi_values) {
+            std::vector<IRBlock> chain;
+            for (int k = 0; k < count; ++k) {
+                std::vector<IRBlock> copy = cloneBody(phi_values);
+                if (!chain.empty()) {
+                    for (auto& label : chain[chain.size() - body_blocks.size() + latch_pos].insts.back().labels) {
+                        if (label == header_label) label = copy[0].label;
+                    }
+                }
+                chain.insert(chain.end(), copy.begin(), copy.end());
+            }
+            return chain;
+        };
+        auto chainLatch = [&](const std::vector<IRBlock>& chain) {
+            return chain[chain.size() - body_blocks.size() + latch_pos].label;
+        };
+        auto retarget = [](IRBlock& block, const std::string& from, const std::string& to) {
+            for (auto& label : block.insts.back().labels) {
+                if (label == from) label = to;
+            }
+        };
+
+        if (factor == 0) {
+            // 完全展开：前置块 -> 第 1 份 -> ... -> 第 T 份 -> 出口，循环头 phi 的使用改为最终值
+            std::map<std::string, std::string> phi_values = entry_values;
+            std::vector<IRBlock> chain = cloneChain(trips, phi_values);
+            std::string exit_label = func.blocks[exit].label;
+            std::string last_label = chain.empty() ? pre_label : chainLatch(chain);
+            if (!chain.empty()) retarget(chain[chain.size() - body_blocks.size() + latch_pos], header_label, exit_label);
+            retarget(func.blocks[loop.preheader], header_label, chain.empty() ? exit_label : chain[0].label);
+            for (auto& inst : func.blocks[exit].insts) {
+                if (inst.opcode != IROpcode::Phi) break;
+                for (auto& label : inst.labels) {
+                    if (label == header_label) label = last_label;
+                }
+            }
+            std::set<std::string> removed = {header_label};
+            for (int b : body_blocks) removed.insert(func.blocks[b].label);
+            std::vector<IRBlock> blocks;
+            for (auto& block : func.blocks) {
+                if (block.label == header_label) blocks.insert(blocks.end(), chain.begin(), chain.end());
+                if (!removed.count(block.label)) blocks.push_back(std::move(block));
+            }
+            func.blocks = std::move(blocks);
+            replaceUses(func, phi_values);
+        } else {
+            // 部分展开：余数迭代放在循环头之前，循环内第 1 份（原循环体）之后接着复制 U - 1 份
+            std::map<std::string, std::string> peel_values = entry_values;
+            std::vector<IRBlock> peel = cloneChain(trips % factor, peel_values);
+            std::map<std::string, std::string> loop_values = back_values;
+            std::vector<IRBlock> unrolled = cloneChain(factor - 1, loop_values);
+            retarget(func.blocks[latch], header_label, unrolled[0].label);
+            if (!peel.empty()) retarget(func.blocks[loop.preheader], header_label, peel[0].label);
+            std::string peel_label = peel.empty() ? pre_label : chainLatch(peel);
+            std::string back_label = chainLatch(unrolled);
+            for (size_t k = 0; k < first; ++k) {
+                IRInst& phi = header.insts[k];
+                for (size_t j = 0; j < phi.labels.size(); ++j) {
+                    if (phi.labels[j] == pre_label) {
+                        phi.operands[j] = peel_values[phi.dest];
+                        phi.labels[j] = peel_label;
+                    } else {
+                        phi.operands[j] = loop_values[phi.dest];
+                        phi.labels[j] = back_label;
+                    }
+                }
+            }
+            int last = *std::max_element(body_blocks.begin(), body_blocks.end());
+            func.blocks.insert(func.blocks.begin() + last + 1, unrolled.begin(), unrolled.end());
+            func.blocks.insert(func.blocks.begin() + loop.header, peel.begin(), peel.end());
+        }
+    }
+}
+
+// * 函数内联：按模块顺序处理，被调函数此时已完成优化。自递归函数不内联，其余函数在指令数
+// 不超过 INLINE_SIZE、或只有一个调用点且不超过 INLINE_SINGLE_SIZE 时内联，调用者总指令数不超过
+// MAX_INLINE_CALLER。形参直接替换为实参，标签与值全部重命名，alloca 移到调用者入口块；
+// ret 改为跳到调用点之后的续块，返回值由续块开头的 phi 汇合（只有一个 ret 时由 removeTrivialPhis 消去）
+void IROptimizer::inlineCalls(IRFunction& func) {
+    std::map<std::string, const IRFunction*> functions;
+    for (const auto& f : module.functions) functions[f.name] = &f;
+    auto instCount = [](const IRFunction& f) {
+        int count = 0;
+        for (const auto& block : f.blocks) count += (int)block.insts.size();
+        return count;
+    };
+    auto inlinable = [](const IRFunction& f) {
+        for (const auto& block : f.blocks) {
+            for (const auto& inst : block.insts) {
+                if (inst.opcode == IROpcode::Unknown) return false;
+                if (inst.opcode == IROpcode::Call && inst.callee == f.name) return false;
+            }
+        }
+        return !f.blocks.empty();
+    };
+
+    int caller_size = instCount(func);
+    for (size_t b = 0; b < func.blocks.size(); ++b) {
+        for (size_t k = 0; k < func.blocks[b].insts.size(); ++k) {
+            if (func.blocks[b].insts[k].opcode != IROpcode::Call) continue;
+            IRInst call = func.blocks[b].insts[k];
+            auto it = functions.find(call.callee);
+            if (it == functions.end() || it->second == &func) continue;
+            const IRFunction& callee = *it->second;
+            int size = instCount(callee);
+            bool small = size <= INLINE_SIZE;
+            bool single = call_sites[callee.name] == 1 && size <= INLINE_SINGLE_SIZE;
+            if (!(small || single) || caller_size + size > MAX_INLINE_CALLER || !inlinable(callee) ||
+                callee.params.size() != call.operands.size()) {
+                continue;
+            }
+            caller_size += size;
+            call_sites[callee.name]--;
+
+            std::map<std::string, std::string> values, labels;
+            for (size_t i = 0; i < callee.params.size(); ++i) values[callee.params[i].second] = call.operands[i];
+            for (const auto& block : callee.blocks) {
+                labels[block.label] = newBlockLabel("inline");
+                for (const auto& inst : block.insts) {
+                    if (!inst.dest.empty()) values[inst.dest] = newValueName("inline");
+                    if (inst.opcode == IROpcode::Call) call_sites[inst.callee]++;
+                }
+            }
+
+            // 调用点之后的指令移到续块，原先以本块为前驱的 phi 改为以续块为前驱
+            IRBlock cont;
+            cont.label = newBlockLabel("inline");
+            std::string block_label = func.blocks[b].label;
+            auto& insts = func.blocks[b].insts;
+            cont.insts.assign(insts.begin() + k + 1, insts.end());
+            insts.resize(k);
+            IRInst br;
+            br.opcode = IROpcode::Br;
+            br.labels = {labels[callee.blocks[0].label]};
+            insts.push_back(br);
+            for (auto& block : func.blocks) {
+                for (auto& inst : block.insts) {
+                    if (inst.opcode != IROpcode::Phi) break;
+                    for (auto& label : inst.labels) {
+                        if (label == block_label) label = cont.label;
+                    }
+                }
+            }
+
+            IRInst result;
+            result.opcode = IROpcode::Phi;
+            result.dest = call.dest;
+            result.type = call.type;
+            std::vector<IRBlock> clones;
+            std::vector<IRInst> allocas;
+            for (const auto& block : callee.blocks) {
+                IRBlock clone;
+                clone.label = labels[block.label];
+                for (IRInst inst : block.insts) {
+                    if (!inst.dest.empty()) inst.dest = values[inst.dest];
+                    for (auto& op : inst.operands) {
+                        auto value = values.find(op);
+                        if (value != values.end()) op = value->second;
+                    }
+                    for (auto& label : inst.labels) label = labels[label];
+                    if (inst.opcode == IROpcode::Alloca) {
+                        allocas.push_back(inst);
+                        continue;
+                    }
+                    if (inst.opcode == IROpcode::Ret) {
+                        if (!call.dest.empty()) {
+                            result.operands.push_back(inst.operands[0]);
+                            result.labels.push_back(clone.label);
+                        }
+                        inst = br;
+                        inst.labels = {cont.label};
+                    }
+                    clone.insts.push_back(inst);
+                }
+                clones.push_back(clone);
+            }
+            if (!call.dest.empty()) cont.insts.insert(cont.insts.begin(), result);
+            clones.push_back(cont);
+            func.blocks.insert(func.blocks.begin() + b + 1, clones.begin(), clones.end());
+            auto& entry = func.blocks[0].insts;
+            entry.insert(entry.begin(), allocas.begin(), allocas.end());
+            b += clones.size() - 1; // 从续块继续扫描，不再处理内联进来的块
+            break;
+        }
+    }
+}
+
+// 删除内联后不再被调用的函数（main 除外）
+void IROptimizer::removeUnusedFunctions() {
+    std::set<std::string> called;
+    for (const auto& func : module.functions) {
+        for (const auto& block : func.blocks) {
+            for (const auto& inst : block.insts) {
+                if (inst.opcode == IROpcode::Call) called.insert(inst.callee);
+            }
+        }
+    }
+    std::vector<IRFunction> functions;
+    for (auto& func : module.functions) {
+        if (func.name == "main" || called.count(func.name)) functions.push_back(std::move(func));
+    }
+    module.functions = std::move(functions);
+}
+
+// * 尾递归消除：调用自身后紧跟 ret 该结果（或 void 调用后 ret void）的调用改为跳回函数开头，
+// 形参改为循环头中的 phi，栈深度不再随递归层数增长。原入口块改名作为循环头，新建的入口块只跳转过去；
+// 函数内有 alloca 时不处理（各层递归的局部数组不能共用）
+void IROptimizer::eliminateTailRecursion(IRFunction& func) {
+    std::vector<size_t> sites;
+    for (size_t b = 0; b < func.blocks.size(); ++b) {
+        const auto& insts = func.blocks[b].insts;
+        for (const auto& inst : insts) {
+            if (inst.opcode == IROpcode::Alloca) return;
+        }
+        if (insts.size() < 2) continue;
+        const IRInst& call = insts[insts.size() - 2];
+        const IRInst& ret = insts.back();
+        if (call.opcode != IROpcode::Call || call.callee != func.name || ret.opcode != IROpcode::Ret) continue;
+        bool void_tail = call.dest.empty() && ret.operands.empty();
+        bool value_tail = !call.dest.empty() && ret.operands.size() == 1 && ret.operands[0] == call.dest;
+        if ((void_tail || value_tail) && call.operands.size() == func.params.size()) sites.push_back(b);
+    }
+    if (sites.empty()) return;
+
+    std::string entry_label = func.blocks[0].label;
+    std::string header_label = newBlockLabel("tail_recurse");
+    for (auto& block : func.blocks) {
+        for (auto& inst : block.insts) {
+            if (inst.opcode != IROpcode::Phi) break;
+            for (auto& label : inst.labels) {
+                if (label == entry_label) label = header_label;
+            }
+        }
+    }
+    std::vector<IRInst> phis;
+    std::map<std::string, std::string> replacement;
+    for (const auto& param : func.params) {
+        IRInst phi;
+        phi.opcode = IROpcode::Phi;
+        phi.dest = newValueName("tail");
+        phi.type = param.first;
+        phi.operands = {param.second};
+        phi.labels = {entry_label};
+        replacement[param.second] = phi.dest;
+        phis.push_back(phi);
+    }
+    replaceUses(func, replacement);
+    IRInst br;
+    br.opcode = IROpcode::Br;
+    br.labels = {header_label};
+    for (size_t b : sites) {
+        auto& insts = func.blocks[b].insts;
+        const IRInst& call = insts[insts.size() - 2];
+        for (size_t i = 0; i < phis.size(); ++i) {
+            phis[i].operands.push_back(call.operands[i]);
+            phis[i].labels.push_back(func.blocks[b].label == entry_label ? header_label : func.blocks[b].label);
+        }
+        insts.resize(insts.size() - 2);
+        insts.push_back(br);
+    }
+    func.blocks[0].label = header_label;
+    func.blocks[0].insts.insert(func.blocks[0].insts.begin(), phis.begin(), phis.end());
+    IRBlock entry;
+    entry.label = entry_label;
+    entry.insts.push_back(br);
+    func.blocks.insert(func.blocks.begin(), entry);
+}
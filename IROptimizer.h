@@ -0,0 +1,77 @@
+// IROptimizer.h
+// 中端优化：在 IRModule 上运行的一组优化 Pass
+#ifndef COMPILER_IROPTIMIZER_H
+#define COMPILER_IROPTIMIZER_H
+
+#include "IRModule.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// 函数的控制流图与支配树（块以 IRFunction::blocks 中的下标表示）
+struct FunctionCFG {
+    std::vector<std::vector<int>> succ, pred;
+    std::vector<int> rpo;                    // 从入口出发的逆后序
+    std::vector<int> idom;                   // 直接支配者；入口为自身，不可达块为 -1
+    std::vector<std::vector<int>> dom_children;
+
+    bool dominates(int a, int b) const;
+    std::map<int, std::set<int>> naturalLoops() const; // 循环头 -> 循环体（块下标）
+};
+
+// 正在变换的循环：CFG、循环头、循环体与前置块（块下标）
+struct LoopContext {
+    FunctionCFG cfg;
+    int header = -1;
+    std::set<int> body;
+    int preheader = -1;
+};
+
+class IROptimizer {
+private:
+    IRModule& module;
+    int block_count; // 新建基本块的编号（标签在整个模块内唯一）
+    int value_count; // 新建值的编号
+    std::map<std::string, int> constant_globals; // 从未被写入的标量全局变量 -> 初始值
+    int unroll_budget; // 循环展开后循环体的指令数上限，0 表示不展开
+    std::map<std::string, int> call_sites; // 函数 -> 模块中调用它的 call 指令数
+
+    // CFG 工具
+    FunctionCFG buildCFG(const IRFunction& func);
+    std::string newBlockLabel(const std::string& prefix);
+    std::string newValueName(const std::string& prefix);
+    void replaceUses(IRFunction& func, const std::map<std::string, std::string>& replacement);
+
+    // 各优化 Pass
+    void inlineCalls(IRFunction& func);        // 小函数与单调用点函数内联
+    void removeUnusedFunctions();
+    void removeUnreachableBlocks(IRFunction& func);
+    void promoteAllocas(IRFunction& func);     // mem2reg：标量 alloca 提升为 SSA 值
+    void removeTrivialPhis(IRFunction& func);
+    void splitCriticalEdges(IRFunction& func); // 拆分通往 phi 所在块的关键边
+    void findConstantGlobals();
+    void propagateConstants(IRFunction& func); // SCCP：稀疏条件常量传播
+    void eliminateDeadCode(IRFunction& func);  // 标记-清除式死代码删除
+    void eliminateTailRecursion(IRFunction& func); // 自身尾调用改为跳回函数开头的循环
+    int getPreheader(IRFunction& func, const FunctionCFG& cfg, int header, const std::set<int>& body);
+    std::vector<std::string> loopHeadersInnermostFirst(const IRFunction& func);
+    bool prepareLoop(IRFunction& func, const std::string& header_label, LoopContext& loop);
+    void hoistLoopInvariants(IRFunction& func); // LICM：循环不变量外提
+    void reduceInductionVariables(IRFunction& func); // 归纳变量强度削弱：数组下标改为指针步进
+    void unrollLoops(IRFunction& func); // 常量迭代次数的循环完全/部分展开
+    void rotateLoops(IRFunction& func); // 循环旋转：入口保护 + 底部测试
+
+public:
+    static constexpr int DEFAULT_UNROLL_BUDGET = 64;
+    static constexpr int MAX_UNROLL_FACTOR = 8;      // 部分展开的最大倍数
+    static constexpr int MAX_UNROLL_TRIPS = 1 << 16; // 模拟迭代次数的上限
+    static constexpr int INLINE_SIZE = 30;           // 任意调用点都内联的被调函数指令数上限
+    static constexpr int INLINE_SINGLE_SIZE = 300;   // 只有一个调用点时的上限
+    static constexpr int MAX_INLINE_CALLER = 3000;   // 内联后调用者的指令数上限
+
+    explicit IROptimizer(IRModule& module, int unroll_budget = DEFAULT_UNROLL_BUDGET);
+    void run();
+};
+
+#endif //COMPILER_IROPTIMIZER_H
@@ -1,1019 +1,1704 @@
-//
-// Created by W on 2025/11/26.
-//
-
-#include "MipsGenerator.h"
-#include <iostream>
-#include <algorithm>
-#include <climits>
-std::string current_function_name;
-MipsGenerator::MipsGenerator(const std::string& llvm_path, const std::string& mips_path) {
-    llvm_file.open(llvm_path);
-    mips_file.open(mips_path);
-    current_stack_offset = 0;
-    time_counter = 0;
-    current_function_name = "";
-
-    // 初始化寄存器状态
-    for(int i=0; i<10; i++) {
-        regs[i].busy = false;
-        regs[i].dirty = false;
-        regs[i].last_use = 0;
-    }
-}
-
-MipsGenerator::~MipsGenerator() {
-    if (llvm_file.is_open()) llvm_file.close();
-    if (mips_file.is_open()) mips_file.close();
-}
-
-void MipsGenerator::emit(const std::string& asm_code) {
-    mips_file << "    " << asm_code << "\n";
-}
-
-// 检查偏移是否在 16 位有符号立即数范围内
-static bool isSmallOffset(int offset) {
-    return offset >= -32768 && offset <= 32767;
-}
-
-// 生成 lw 指令，处理大偏移
-void MipsGenerator::emitLoadWord(const std::string& dest_reg, int offset, const std::string& base_reg) {
-    if (isSmallOffset(offset)) {
-        emit("lw " + dest_reg + ", " + std::to_string(offset) + "(" + base_reg + ")");
-    } else {
-        // 大偏移：使用 $v1 作为临时寄存器 (不使用 $at，因为 SPIM 保留)
-        emit("li $v1, " + std::to_string(offset));
-        emit("addu $v1, " + base_reg + ", $v1");
-        emit("lw " + dest_reg + ", 0($v1)");
-    }
-}
-
-// 生成 sw 指令，处理大偏移
-void MipsGenerator::emitStoreWord(const std::string& src_reg, int offset, const std::string& base_reg) {
-    if (isSmallOffset(offset)) {
-        emit("sw " + src_reg + ", " + std::to_string(offset) + "(" + base_reg + ")");
-    } else {
-        // 大偏移：使用 $v1 作为临时寄存器 (不使用 $at，因为 SPIM 保留)
-        emit("li $v1, " + std::to_string(offset));
-        emit("addu $v1, " + base_reg + ", $v1");
-        emit("sw " + src_reg + ", 0($v1)");
-    }
-}
-
-// 生成地址加载指令 (addiu)，处理大偏移
-void MipsGenerator::emitLoadAddress(const std::string& dest_reg, int offset, const std::string& base_reg) {
-    if (isSmallOffset(offset)) {
-        emit("addiu " + dest_reg + ", " + base_reg + ", " + std::to_string(offset));
-    } else {
-        // 大偏移：使用 li + addu
-        emit("li " + dest_reg + ", " + std::to_string(offset));
-        emit("addu " + dest_reg + ", " + base_reg + ", " + dest_reg);
-    }
-}
-
-bool MipsGenerator::isNumber(const std::string& s) {
-    if (s.empty()) return false;
-    size_t start = 0;
-    if (s[0] == '-' || s[0] == '+') start = 1;
-    for (size_t i = start; i < s.size(); ++i) {
-        if (!isdigit(s[i])) return false;
-    }
-    return true;
-}
-
-// * 判断是否为临时变量（%0, %1 等数字开头的变量）
-static bool isTempVar(const std::string& name) {
-    if (name.empty() || name[0] != '%') return false;
-    if (name.length() < 2) return false;
-    return isdigit(name[1]);
-}
-
-// * 检查立即数是否在 16 位有符号范围内（可用于 addiu, ori 等）
-bool MipsGenerator::isSmallImmediate(int val) {
-    return val >= -32768 && val <= 32767;
-}
-
-// * 预分析函数，统计变量使用次数（用于死代码消除）
-void MipsGenerator::preAnalyzeFunction(const std::vector<std::string>& instructions) {
-    var_use_count.clear();
-    for (const auto& line : instructions) {
-        std::stringstream ss(line);
-        std::string token;
-        ss >> token;
-
-        // 统计所有 % 开头的变量使用
-        std::string rest = line;
-        size_t pos = 0;
-        while ((pos = rest.find('%', pos)) != std::string::npos) {
-            size_t end = pos + 1;
-            while (end < rest.size() && (isalnum(rest[end]) || rest[end] == '_' || rest[end] == '.')) {
-                end++;
-            }
-            std::string var = rest.substr(pos, end - pos);
-            if (!var.empty() && var != "%") {
-                var_use_count[var]++;
-            }
-            pos = end;
-        }
-    }
-
-    // 定义的变量减去一次（因为定义本身不算使用）
-    for (const auto& line : instructions) {
-        if (line.find(" = ") != std::string::npos) {
-            std::stringstream ss(line);
-            std::string dest;
-            ss >> dest;
-            if (dest[0] == '%') {
-                var_use_count[dest]--;
-            }
-        }
-    }
-}
-
-std::string MipsGenerator::getRegName(int index) {
-    return "$t" + std::to_string(index);
-}
-
-// 分配栈空间（如果尚未分配）
-void MipsGenerator::allocStack(const std::string& var_name, int size) {
-    if (stack_map.find(var_name) == stack_map.end()) {
-        current_stack_offset -= size;
-        stack_map[var_name] = current_stack_offset;
-    }
-}
-
-int MipsGenerator::getStackOffset(const std::string& var_name) {
-    if (stack_map.find(var_name) == stack_map.end()) {
-        allocStack(var_name); // 兜底分配
-    }
-    return stack_map[var_name];
-}
-
-// --- 寄存器分配核心 ---
-
-// 溢出策略：LRU (Least Recently Used)
-int MipsGenerator::spillReg() {
-    int victim = -1;
-    int min_time = INT_MAX;
-
-    // 找到 last_use 最小的寄存器
-    for (int i = 0; i < 10; ++i) {
-        if (regs[i].busy && regs[i].last_use < min_time) {
-            min_time = regs[i].last_use;
-            victim = i;
-        }
-    }
-
-    if (victim == -1) {
-        // 理论上不会发生，除非所有寄存器都空（逻辑错误）
-        return 0;
-    }
-
-    // 执行溢出操作
-    std::string var = regs[victim].name;
-    // * alloca 变量不需要溢出（它的值是地址，是常量）
-    if (regs[victim].dirty && !(is_alloca_var.count(var) && is_alloca_var[var])) {
-        int offset = getStackOffset(var);
-        emitStoreWord(getRegName(victim), offset, "$fp");
-        emit("# Spill " + var);
-    }
-
-    // 清理状态
-    var_in_reg.erase(var);
-    regs[victim].busy = false;
-    regs[victim].dirty = false;
-
-    return victim;
-}
-
-int MipsGenerator::findFreeReg() {
-    for (int i = 0; i < 10; ++i) {
-        if (!regs[i].busy) return i;
-    }
-    return -1;
-}
-
-// 获取寄存器
-// var_name: 变量名或立即数
-// is_def: 是否是定义的变量（即作为赋值目标）。如果是，不需要从内存加载旧值。
-// is_addr: 特殊标记，如果是 store 的地址部分，确保它在寄存器
-int MipsGenerator::getReg(const std::string& var_name, bool is_def, bool is_addr) {
-    time_counter++;
-
-    // 1. 如果是数字立即数
-    // 我们分配一个临时寄存器装载它，通常不记录在 var_in_reg 中，用完即扔（或者可以优化）
-    // 为了简化 LRU 逻辑，这里我们也将其视为普通变量，但名字要是唯一的（防止冲突）
-    if (isNumber(var_name)) {
-        int val = std::stoi(var_name);
-        // * 优化：0 可以直接使用 $zero 寄存器的值
-        int reg = findFreeReg();
-        if (reg == -1) reg = spillReg();
-
-        if (val == 0) {
-            emit("move " + getRegName(reg) + ", $zero");
-        } else {
-            emit("li " + getRegName(reg) + ", " + var_name);
-        }
-        // 数字不占用 var_in_reg 映射，只是临时占用寄存器
-        regs[reg].busy = true;
-        regs[reg].name = ""; // 匿名
-        regs[reg].dirty = false;
-        regs[reg].last_use = time_counter;
-        return reg;
-    }
-
-    // 2. 如果变量已经在寄存器中
-    if (var_in_reg.count(var_name)) {
-        int reg = var_in_reg[var_name];
-        regs[reg].last_use = time_counter;
-        if (is_def) regs[reg].dirty = true; // 如果这次是写操作，标记为脏
-        return reg;
-    }
-
-    // 3. 需要分配新寄存器
-    int reg = findFreeReg();
-    if (reg == -1) reg = spillReg();
-
-    // 4. 占用寄存器
-    regs[reg].busy = true;
-    regs[reg].name = var_name;
-    regs[reg].last_use = time_counter;
-    var_in_reg[var_name] = reg;
-
-    // 5. 如果是读操作（不是定义），则从栈加载旧值
-    if (!is_def) {
-        if (var_name[0] == '@') {
-            // 【处理全局变量/常量 (@)】
-            std::string raw_label = var_name.substr(1);
-            // 字符串常量以 .str 开头不需要前缀，其他全局变量需要 _ 前缀
-            std::string global_label = (raw_label[0] == '.') ? raw_label : ("_" + raw_label);
-            if (is_addr) {
-                // 只取地址（用于 load/store 指令的指针操作数）
-                emit("la " + getRegName(reg) + ", " + global_label + " # Load Global Address of " + var_name);
-            } else {
-                // 取值（用于普通表达式）
-                emit("la " + getRegName(reg) + ", " + global_label + " # Load Global Address of " + var_name);
-                emit("lw " + getRegName(reg) + ", 0(" + getRegName(reg) + ") # Load Global Value " + var_name);
-            }
-            regs[reg].dirty = false;
-        } else if (is_alloca_var.count(var_name) && is_alloca_var[var_name]) {
-            // * alloca 变量：其值是地址，计算 $fp + offset
-            int offset = getStackOffset(var_name);
-            emitLoadAddress(getRegName(reg), offset, "$fp");
-            emit("# Address of " + var_name);
-            regs[reg].dirty = false;
-        } else {
-            // 普通局部变量/临时变量: 从栈加载值
-            int offset = getStackOffset(var_name);
-            emitLoadWord(getRegName(reg), offset, "$fp");
-            emit("# Load " + var_name);
-            regs[reg].dirty = false;
-        }
-    } else {
-        // 定义操作，标记为 dirty
-        // ! 不能用单次使用优化，因为 flush 会导致问题
-        regs[reg].dirty = true;
-    }
-    return reg;
-}
-
-// 强制写回所有脏寄存器（在跳转、函数调用、Label前调用）
-void MipsGenerator::flushRegisters() {
-    for (int i = 0; i < 10; ++i) {
-        if (regs[i].busy) {
-            // * alloca 变量不需要写回（它的值是地址，是常量）
-            if (regs[i].dirty && !regs[i].name.empty() &&
-                !(is_alloca_var.count(regs[i].name) && is_alloca_var[regs[i].name])) {
-                int offset = getStackOffset(regs[i].name);
-                emitStoreWord(getRegName(i), offset, "$fp");
-                emit("# Flush " + regs[i].name);
-            }
-            regs[i].busy = false;
-            regs[i].dirty = false;
-            regs[i].name = "";
-        }
-    }
-    var_in_reg.clear();
-}
-
-// --- 流程控制 ---
-
-void MipsGenerator::generate() {
-    if (!llvm_file.is_open() || !mips_file.is_open()) return;
-
-    mips_file << ".data\n";
-    parseGlobalVars();
-
-    mips_file << "\n.text\n";
-    mips_file << "jal main\n";
-    mips_file << "li $v0, 10\nsyscall\n";
-
-    llvm_file.clear();
-    llvm_file.seekg(0);
-    parseFunctions();
-}
-
-void MipsGenerator::parseGlobalVars() {
-    // 解析全局变量和常量数组
-    std::string line;
-    while (std::getline(llvm_file, line)) {
-        // * 处理全局变量: @name = global i32 0, align 4
-        // 注意：排除字符串常量（@.str 开头）
-        if (line.find("@") == 0 && line.find("@.str") == std::string::npos && line.find("= global") != std::string::npos) {
-            std::stringstream ss(line);
-            std::string name_token;
-            ss >> name_token;
-            std::string name = name_token.substr(1);
-            // 添加下划线前缀，避免与 MIPS 指令名（如 b, j）冲突
-            mips_file << "_" << name << ": ";
-
-            if (line.find("zeroinitializer") != std::string::npos) {
-                // 数组零初始化，解析 [N x i32]
-                size_t bracket_start = line.find('[');
-                size_t x_pos = line.find('x');
-                if (bracket_start != std::string::npos && x_pos != std::string::npos) {
-                    int num = std::stoi(line.substr(bracket_start + 1, x_pos - bracket_start - 1));
-                    mips_file << ".word 0:" << num << "\n";
-                } else {
-                    mips_file << ".word 0\n";
-                }
-            } else if (line.find("] [") != std::string::npos) {
-                // * 带初始化列表的数组: @arr = global [N x i32] [i32 10, i32 25, ...], align 4
-                size_t init_start = line.find("] [");
-                if (init_start != std::string::npos) {
-                    init_start += 3; // 跳过 "] ["
-                    size_t init_end = line.find("]", init_start);
-                    std::string init_list = line.substr(init_start, init_end - init_start);
-
-                    // 解析 i32 N, i32 M, ...
-                    std::vector<int> values;
-                    std::stringstream init_ss(init_list);
-                    std::string token;
-                    while (std::getline(init_ss, token, ',')) {
-                        size_t i32_pos = token.find("i32");
-                        if (i32_pos != std::string::npos) {
-                            std::string num_str = token.substr(i32_pos + 3);
-                            // 去除空格
-                            num_str.erase(0, num_str.find_first_not_of(" \t"));
-                            num_str.erase(num_str.find_last_not_of(" \t") + 1);
-                            if (!num_str.empty()) {
-                                values.push_back(std::stoi(num_str));
-                            }
-                        }
-                    }
-
-                    // 输出数组值 (SPIM 用逗号分隔)
-                    mips_file << ".word ";
-                    for (size_t i = 0; i < values.size(); ++i) {
-                        if (i > 0) mips_file << ", ";
-                        mips_file << values[i];
-                    }
-                    mips_file << "\n";
-                }
-            } else {
-                // * 简单标量初始化: @c = global i32 3, align 4
-                // 解析 "global i32 <value>" 中的 value
-                size_t i32_pos = line.find("i32 ");
-                if (i32_pos != std::string::npos) {
-                    std::string rest = line.substr(i32_pos + 4);
-                    // 提取数字直到逗号或空格
-                    size_t end = rest.find_first_of(", ");
-                    std::string value_str = rest.substr(0, end);
-                    // 去除前后空格
-                    value_str.erase(0, value_str.find_first_not_of(" \t"));
-                    value_str.erase(value_str.find_last_not_of(" \t") + 1);
-                    mips_file << ".word " << value_str << "\n";
-                } else {
-                    mips_file << ".word 0\n";
-                }
-            }
-        }
-        // * 处理常量数组: @ia1_9 = constant [5 x i32] [i32 1, i32 2, ...], align 4
-        // ! 注意：不能以 @.str 开头（那是字符串常量）
-        else if (line.find("@") == 0 && line.find("@.str") == std::string::npos && line.find("constant") != std::string::npos && line.find("x i32]") != std::string::npos) {
-            std::stringstream ss(line);
-            std::string name_token;
-            ss >> name_token;
-            std::string name = name_token.substr(1);
-            // 添加下划线前缀，避免与 MIPS 指令名冲突
-            mips_file << "_" << name << ": .word ";
-
-            // 提取数组初始化值 [i32 1, i32 2, i32 3, ...]
-            size_t init_start = line.find("] [");
-            if (init_start != std::string::npos) {
-                init_start += 3; // 跳过 "] ["
-                size_t init_end = line.find("]", init_start);
-                std::string init_list = line.substr(init_start, init_end - init_start);
-
-                // 解析 i32 N, i32 M, ...
-                std::vector<int> values;
-                std::stringstream init_ss(init_list);
-                std::string token;
-                while (std::getline(init_ss, token, ',')) {
-                    size_t i32_pos = token.find("i32");
-                    if (i32_pos != std::string::npos) {
-                        std::string num_str = token.substr(i32_pos + 3);
-                        // 去除空格
-                        num_str.erase(0, num_str.find_first_not_of(" \t"));
-                        num_str.erase(num_str.find_last_not_of(" \t") + 1);
-                        if (!num_str.empty()) {
-                            values.push_back(std::stoi(num_str));
-                        }
-                    }
-                }
-
-                // 输出数组值 (SPIM 用逗号分隔)
-                for (size_t i = 0; i < values.size(); ++i) {
-                    if (i > 0) mips_file << ", ";
-                    mips_file << values[i];
-                }
-                mips_file << "\n";
-            }
-        }
-        // * 处理字符串常量: @.str = private unnamed_addr constant [6 x i8] c"crsb\0A\00", align 1
-        else if (line.find("@.str") != std::string::npos && line.find("constant") != std::string::npos) {
-            // 字符串常量处理：@.str = private unnamed_addr constant [6 x i8] c"crsb\0A\00", align 1
-            std::stringstream ss(line);
-            std::string name;
-            ss >> name;
-            mips_file << name.substr(1) << ": .asciiz ";
-
-            // 找到字符串部分：c"..."
-            size_t c_start = line.find("c\"");
-            size_t c_end = line.rfind('\"');
-
-            if (c_start != std::string::npos && c_end != std::string::npos && c_end > c_start) {
-                // 提取 c"..." 中的内容，跳过 c"
-                std::string raw_content = line.substr(c_start + 2, c_end - (c_start + 2));
-
-                std::string processed_content = "\"";
-                for (size_t i = 0; i < raw_content.length(); ++i) {
-                    if (raw_content[i] == '\\' && i + 2 < raw_content.length()) {
-                        // 处理转义序列，如 \0A, \00
-                        std::string hex = raw_content.substr(i + 1, 2);
-                        if (hex == "0A") {
-                            processed_content += "\\n"; // LLVM \0A -> MIPS \n
-                            i += 2;
-                        } else if (hex == "09") {
-                            processed_content += "\\t"; // LLVM \09 -> MIPS \t
-                            i += 2;
-                        } else if (hex == "00") {
-                            // \00 是字符串结束符，.asciiz 会自动添加
-                            i += 2;
-                            continue;
-                        } else {
-                            // 如果是其他转义，保持原样 (不推荐，但作为兜底)
-                            processed_content += raw_content[i];
-                        }
-                    } else {
-                        processed_content += raw_content[i];
-                    }
-                }
-                processed_content += "\"";
-                mips_file << processed_content << "\n";
-            }
-        }
-    }
-}
-
-void MipsGenerator::parseFunctions() {
-    std::string line;
-    std::vector<std::string> func_lines; // * 缓存当前函数的所有指令
-    bool in_function = false;
-    std::string current_func_header;
-
-    while (std::getline(llvm_file, line)) {
-        if (line.empty()) continue;
-        std::stringstream ss(line);
-        std::string token;
-        ss >> token;
-
-        if (token == "define") {
-            in_function = true;
-            current_func_header = line;
-            func_lines.clear();
-        }
-        else if (token == "}") {
-            if (in_function) {
-                // * 预分析函数内所有指令
-                preAnalyzeFunction(func_lines);
-
-                flushRegisters(); // 安全起见
-                stack_map.clear();
-                is_alloca_var.clear(); // 清空 alloca 标记
-                current_stack_offset = 0;
-
-                // 从完整的 line 解析函数定义
-                // 格式: define i32 @func2(i32 %arg1, i32 %arg2) {
-                size_t at_pos = current_func_header.find('@');
-                size_t paren_start = current_func_header.find('(');
-                size_t paren_end = current_func_header.find(')');
-
-                std::string func_name = current_func_header.substr(at_pos + 1, paren_start - at_pos - 1);
-
-                mips_file << "\n" << func_name << ":\n";
-                // Prologue
-                // 栈布局: $sp(原) -> [$fp saved], [$ra saved], [locals...]
-                // 先减 $sp 为保存区腾出空间
-                emit("subu $sp, $sp, 8");     // 为 $fp 和 $ra 预留空间
-                emit("sw $fp, 4($sp)");       // 保存旧 $fp 在 $sp+4
-                emit("sw $ra, 0($sp)");       // 保存旧 $ra 在 $sp+0
-                emit("addiu $fp, $sp, 8");    // $fp 指向旧栈顶，局部变量从 $fp-12 开始
-                emit("subu $sp, $sp, 2048");  // 栈帧 (小型栈帧)
-                current_stack_offset = -12;   // 局部变量从 $fp-12 开始（跳过保存区）
-
-                // 处理函数参数: 解析参数列表，将 $a0-$a3 保存到栈上
-                if (paren_start != std::string::npos && paren_end != std::string::npos) {
-                    std::string args_str = current_func_header.substr(paren_start + 1, paren_end - paren_start - 1);
-                    if (!args_str.empty()) {
-                        std::vector<std::string> arg_names;
-                        std::stringstream args_ss(args_str);
-                        std::string arg_part;
-                        while (std::getline(args_ss, arg_part, ',')) {
-                            // 去除前后空白
-                            size_t start = arg_part.find_first_not_of(" \t");
-                            if (start == std::string::npos) continue;
-                            arg_part = arg_part.substr(start);
-                            // 格式: "i32 %arg1" 或 "i32* %arg1"
-                            std::stringstream part_ss(arg_part);
-                            std::string type, name;
-                            part_ss >> type >> name;
-                            if (!name.empty()) {
-                                arg_names.push_back(name);
-                            }
-                        }
-                        // 将参数从 $a0-$a3 保存到栈
-                        const char* arg_regs[] = {"$a0", "$a1", "$a2", "$a3"};
-                        for (size_t i = 0; i < arg_names.size() && i < 4; ++i) {
-                            allocStack(arg_names[i]);
-                            int offset = getStackOffset(arg_names[i]);
-                            emitStoreWord(std::string(arg_regs[i]), offset, "$fp");
-                            emit("# Save arg " + arg_names[i]);
-                        }
-                    }
-                }
-
-                // * 处理函数体的所有指令
-                for (const auto& instr : func_lines) {
-                    processInstruction(instr);
-                }
-
-                in_function = false;
-            }
-        }
-        else if (in_function) {
-            func_lines.push_back(line);
-        }
-    }
-}
-
-void MipsGenerator::processInstruction(const std::string& line) {
-    std::stringstream ss(line);
-    std::string token;
-    ss >> token;
-
-    // 1. Label (基本块入口)
-    // 必须 Flush，因为不知道从哪跳过来的
-    if (token.back() == ':') {
-        flushRegisters();
-        std::string label_name = token.substr(0, token.length() - 1);
-        if (label_name == "entry" || label_name == "0") {
-            return;
-        }
-        std::string unique_label = current_function_name + "_" + label_name;
-        mips_file << token << "\n";
-        return;
-    }
-
-    // 2. 赋值指令
-    if (token.find('%') == 0) {
-        std::string dest = token;
-        std::string assign, op;
-        ss >> assign >> op; // = opcode
-
-        if (op == "alloca") {
-            // %1 = alloca i32
-            // 分配栈空间，alloca 的结果是该空间的地址
-            int size = 4;
-            std::string type;
-            ss >> type;
-            if (type.find('[') != std::string::npos) {
-                // [10 x i32] -> 提取 10
-                size_t x = type.find('x');
-                int num = std::stoi(type.substr(1, x-1));
-                size = num * 4;
-            }
-            allocStack(dest, size);
-            // * 标记这个变量是 alloca 出来的，其值是地址
-            is_alloca_var[dest] = true;
-        }
-        else if (op == "add" || op == "sub" || op == "mul" || op == "sdiv" || op == "srem") {
-            // %2 = add nsw i32 %0, %1
-            // 可能有 nsw/nuw 修饰符，需要跳过
-            std::string type, s1, s2;
-            ss >> type;
-            // 跳过 nsw, nuw 等修饰符
-            while (type == "nsw" || type == "nuw") {
-                ss >> type;
-            }
-            ss >> s1 >> s2;
-            if (!s1.empty() && s1.back() == ',') s1.pop_back();
-
-            bool handled = false;
-
-            // * 优化：sub 0, X 可以用 negu（取负）
-            if (op == "sub" && isNumber(s1) && std::stoi(s1) == 0) {
-                int r2 = getReg(s2, false);
-                int rd = getReg(dest, true);
-                emit("negu " + getRegName(rd) + ", " + getRegName(r2));
-                handled = true;
-            }
-            // * 优化：立即数形式指令
-            // add/sub 可以使用 addiu/subiu（MIPS 没有 subiu，用 addiu 负数）
-            if (!handled && op == "add" && isNumber(s2)) {
-                int imm = std::stoi(s2);
-                if (isSmallImmediate(imm)) {
-                    int r1 = getReg(s1, false);
-                    int rd = getReg(dest, true);
-                    emit("addiu " + getRegName(rd) + ", " + getRegName(r1) + ", " + s2);
-                    handled = true;
-                }
-            }
-            if (!handled && op == "sub" && isNumber(s2)) {
-                int imm = std::stoi(s2);
-                if (isSmallImmediate(-imm)) {
-                    int r1 = getReg(s1, false);
-                    int rd = getReg(dest, true);
-                    emit("addiu " + getRegName(rd) + ", " + getRegName(r1) + ", " + std::to_string(-imm));
-                    handled = true;
-                }
-            }
-            // * 优化：乘以 2 的幂次可以用移位
-            if (!handled && op == "mul" && isNumber(s2)) {
-                int imm = std::stoi(s2);
-                if (imm > 0 && (imm & (imm - 1)) == 0) { // 是 2 的幂
-                    int shift = 0;
-                    while ((1 << shift) < imm) shift++;
-                    int r1 = getReg(s1, false);
-                    int rd = getReg(dest, true);
-                    emit("sll " + getRegName(rd) + ", " + getRegName(r1) + ", " + std::to_string(shift));
-                    handled = true;
-                }
-            }
-            // * 优化：除以 2 的幂次可以用移位（仅正数安全）
-            if (!handled && op == "sdiv" && isNumber(s2)) {
-                int imm = std::stoi(s2);
-                if (imm > 0 && (imm & (imm - 1)) == 0) { // 是 2 的幂
-                    int shift = 0;
-                    while ((1 << shift) < imm) shift++;
-                    int r1 = getReg(s1, false);
-                    int rd = getReg(dest, true);
-                    emit("sra " + getRegName(rd) + ", " + getRegName(r1) + ", " + std::to_string(shift));
-                    handled = true;
-                }
-            }
-
-            if (!handled) {
-                int r1 = getReg(s1, false);
-                int r2 = getReg(s2, false);
-                int rd = getReg(dest, true); // dest 是定义
-
-                std::string mips_op = "addu";
-                if (op == "sub") mips_op = "subu";
-                else if (op == "mul") mips_op = "mul";
-                else if (op == "sdiv") mips_op = "div";
-                else if (op == "srem") mips_op = "div"; // 取余也要 div
-
-                if (op == "sdiv") {
-                    emit("div " + getRegName(r1) + ", " + getRegName(r2));
-                    emit("mflo " + getRegName(rd));
-                } else if (op == "srem") {
-                    emit("div " + getRegName(r1) + ", " + getRegName(r2));
-                    emit("mfhi " + getRegName(rd));
-                } else {
-                    emit(mips_op + " " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-                }
-            }
-        }
-        else if (op == "load") {
-            // %0 = load i32, i32* %i_2_addr, align 4
-            // 解析格式: load <val_type>, <ptr_type> <ptr>, align <n>
-            std::string val_type, ptr_type, ptr;
-            ss >> val_type >> ptr_type >> ptr;
-            // 去掉 ptr 末尾的逗号（如果有）
-            if (!ptr.empty() && ptr.back() == ',') ptr.pop_back();
-
-            // 指针地址 - 使用 is_addr=true，只取地址不取值
-            int r_ptr = getReg(ptr, false, true);
-            int r_dest = getReg(dest, true);
-            emit("lw " + getRegName(r_dest) + ", 0(" + getRegName(r_ptr) + ")");
-        }
-        else if (op == "icmp") {
-            // %3 = icmp eq i32 %1, %2
-            std::string cond, type, s1, s2;
-            ss >> cond >> type >> s1 >> s2;
-            if (s1.back() == ',') s1.pop_back();
-
-            // * 优化：与 0 比较时使用 $zero 寄存器
-            bool s2_is_zero = (isNumber(s2) && std::stoi(s2) == 0);
-
-            int r1 = getReg(s1, false);
-            int rd = getReg(dest, true);
-
-            if (s2_is_zero) {
-                // * 与 0 比较，可以用 $zero 寄存器
-                if (cond == "eq") emit("seq " + getRegName(rd) + ", " + getRegName(r1) + ", $zero");
-                else if (cond == "ne") emit("sne " + getRegName(rd) + ", " + getRegName(r1) + ", $zero");
-                else if (cond == "sgt") emit("sgt " + getRegName(rd) + ", " + getRegName(r1) + ", $zero");
-                else if (cond == "sge") emit("sge " + getRegName(rd) + ", " + getRegName(r1) + ", $zero");
-                else if (cond == "slt") emit("slt " + getRegName(rd) + ", " + getRegName(r1) + ", $zero");
-                else if (cond == "sle") emit("sle " + getRegName(rd) + ", " + getRegName(r1) + ", $zero");
-            } else if (cond == "slt" && isNumber(s2) && isSmallImmediate(std::stoi(s2))) {
-                // * 优化：slt 与立即数比较可以用 slti
-                emit("slti " + getRegName(rd) + ", " + getRegName(r1) + ", " + s2);
-            } else {
-                int r2 = getReg(s2, false);
-                if (cond == "eq") emit("seq " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-                else if (cond == "ne") emit("sne " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-                else if (cond == "sgt") emit("sgt " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-                else if (cond == "sge") emit("sge " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-                else if (cond == "slt") emit("slt " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-                else if (cond == "sle") emit("sle " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
-            }
-        }
-        else if (op == "getelementptr") {
-            // %4 = getelementptr inbounds [2 x i8], [2 x i8]* @.str0, i32 0, i32 0
-            // 解析：跳过 inbounds，找到 base 指针和最后一个 offset
-            std::vector<std::string> parts;
-            std::string temp;
-            while (ss >> temp) parts.push_back(temp);
-
-            // 清理逗号
-            for(auto& p : parts) if(!p.empty() && p.back()==',') p.pop_back();
-
-            // 找 base（第一个 * 后面的变量）和 idx（最后一个值）
-            std::string base, idx;
-            for(size_t i = 0; i < parts.size(); i++) {
-                if (parts[i].find('*') != std::string::npos && i + 1 < parts.size()) {
-                    base = parts[i + 1];
-                    break;
-                }
-            }
-            idx = parts.back();
-
-            int r_dest = getReg(dest, true);
-
-            // 如果 base 是全局变量（@ 开头），直接 la 加载地址
-            if (base[0] == '@') {
-                std::string raw_label = base.substr(1);
-                // 字符串常量以 .str 开头不需要前缀，其他全局变量需要 _ 前缀
-                std::string label = (raw_label[0] == '.') ? raw_label : ("_" + raw_label);
-                // 对于字符串常量或数组，offset 通常是 0，直接 la 即可
-                if (isNumber(idx) && std::stoi(idx) == 0) {
-                    emit("la " + getRegName(r_dest) + ", " + label);
-                } else {
-                    // 非零 offset：计算 base + idx * element_size
-                    int r_idx = getReg(idx, false);
-                    emit("sll " + getRegName(r_dest) + ", " + getRegName(r_idx) + ", 2");
-                    int r_temp = findFreeReg();
-                    if (r_temp == -1) r_temp = spillReg();
-                    emit("la " + getRegName(r_temp) + ", " + label);
-                    emit("addu " + getRegName(r_dest) + ", " + getRegName(r_dest) + ", " + getRegName(r_temp));
-                    regs[r_temp].busy = false;
-                }
-            }
-            else {
-                // 局部变量指针
-                int r_base = getReg(base, false);
-                int r_idx = getReg(idx, false);
-                emit("sll " + getRegName(r_dest) + ", " + getRegName(r_idx) + ", 2");
-                emit("addu " + getRegName(r_dest) + ", " + getRegName(r_dest) + ", " + getRegName(r_base));
-            }
-        }
-        else if (op == "zext") {
-            // %2 = zext i1 %1 to i32
-            // MIPS 中不做区分，直接 move
-            std::string type1, s1, to, type2;
-            ss >> type1 >> s1 >> to >> type2;
-            int r_src = getReg(s1, false);
-            int r_dst = getReg(dest, true);
-            // * 优化：源和目标相同时省略 move
-            if (r_src != r_dst) {
-                emit("move " + getRegName(r_dst) + ", " + getRegName(r_src));
-            }
-        }
-        else if (op == "call") {
-            // %3 = call i32 @func(...)
-            // 解析函数名和参数
-            std::string ret_type, func_name;
-            ss >> ret_type >> func_name;
-            size_t p = func_name.find('(');
-            std::string real_name = func_name.substr(1, p-1);
-            std::string args_str = line.substr(line.find('(')+1);
-            args_str.pop_back(); // 去掉 )
-
-            // * 修复：先收集所有参数值到临时寄存器数组，避免参数计算时互相干扰
-            std::vector<std::string> arg_values;  // 保存参数值（变量名或立即数）
-            std::stringstream arg_ss(args_str);
-            std::string segment;
-            while(std::getline(arg_ss, segment, ',')) {
-                std::stringstream seg_ss(segment);
-                std::string type, val;
-                seg_ss >> type >> val;
-                if (!val.empty()) {
-                    arg_values.push_back(val);
-                }
-            }
-
-            // * 先计算所有参数值并保存到栈上的临时位置
-            // 使用固定的临时栈区域来保存参数（避免寄存器分配时的干扰）
-            std::vector<int> arg_stack_offsets;
-            int temp_arg_base = current_stack_offset - 100;  // 使用栈的一个固定区域
-            for (int i = 0; i < (int)arg_values.size() && i < 4; ++i) {
-                int r = getReg(arg_values[i], false);
-                int offset = temp_arg_base - i * 4;
-                emitStoreWord(getRegName(r), offset, "$fp");
-                arg_stack_offsets.push_back(offset);
-            }
-
-            // Flush registers before call!
-            flushRegisters();
-
-            // * 从临时栈位置加载参数到 $a0-$a3
-            for (int i = 0; i < (int)arg_stack_offsets.size() && i < 4; ++i) {
-                std::string arg_reg = "$a" + std::to_string(i);
-                emitLoadWord(arg_reg, arg_stack_offsets[i], "$fp");
-            }
-
-            if (real_name == "getint") {
-                emit("li $v0, 5");
-                emit("syscall");
-                // 结果在 $v0，存入 dest
-                int rd = getReg(dest, true);
-                emit("move " + getRegName(rd) + ", $v0");
-            }
-            else if (real_name == "putint") {
-                emit("li $v0, 1");
-                emit("syscall");
-            }
-            else if (real_name == "putstr") {
-                emit("li $v0, 4");
-                emit("syscall");
-            }
-            else if (real_name == "putch") {
-                emit("li $v0, 11");
-                emit("syscall");
-            }
-            else {
-                emit("jal " + real_name);
-                if (ret_type != "void") {
-                    int rd = getReg(dest, true);
-                    emit("move " + getRegName(rd) + ", $v0");
-                }
-            }
-        }
-    }
-        // 3. Store 指令
-    else if (token == "store") {
-        // store i1 %1, i1* %and_res4, align 1
-        std::string type, val, ptr_type, ptr;
-        ss >> type >> val >> ptr_type >> ptr;
-        // 去掉逗号
-        if (!val.empty() && val.back() == ',') val.pop_back();
-        if (!ptr.empty() && ptr.back() == ',') ptr.pop_back();
-
-        int r_val = getReg(val, false);
-        int r_ptr = getReg(ptr, false, true);  // is_addr=true，只取地址不取值
-
-        emit("sw " + getRegName(r_val) + ", 0(" + getRegName(r_ptr) + ")");
-    }
-        // 4. Ret 指令
-    else if (token == "ret") {
-        // * 优化：ret 前不需要 flush 局部变量，因为栈帧即将销毁
-        // 但需要先获取返回值（如果有）
-        std::string type, val;
-        ss >> type;
-        if (type != "void") {
-            ss >> val;
-            // * 优化：如果返回值是立即数，直接 li $v0
-            if (isNumber(val)) {
-                int imm = std::stoi(val);
-                if (imm == 0) {
-                    emit("move $v0, $zero");
-                } else {
-                    emit("li $v0, " + val);
-                }
-            } else {
-                // 加载返回值到 $v0
-                int r_val = getReg(val, false);
-                emit("move $v0, " + getRegName(r_val));
-            }
-        }
-        // 不需要 flushRegisters()，栈帧即将销毁
-        // 清空寄存器状态即可
-        for (int i = 0; i < 10; ++i) {
-            regs[i].busy = false;
-            regs[i].dirty = false;
-            regs[i].name = "";
-        }
-        var_in_reg.clear();
-
-        // Epilogue
-        // 栈布局: $fp 指向旧栈顶，$ra 在 $fp-8，$fp 在 $fp-4
-        emit("subu $sp, $fp, 8");   // 恢复 $sp 到保存区
-        emit("lw $ra, 0($sp)");     // 恢复 $ra
-        emit("lw $fp, 4($sp)");     // 恢复 $fp
-        emit("addiu $sp, $sp, 8");  // 释放保存区
-        emit("jr $ra");
-    }
-        // 5. Br 指令
-    else if (token == "br") {
-        std::string label_or_cond;
-        ss >> label_or_cond;
-
-        if (label_or_cond == "label") {
-            flushRegisters(); // 无条件跳转前写回
-            std::string label;
-            ss >> label; // %label1
-            emit("j " + label.substr(1));
-        } else {
-            // br i1 %cond, label %true, label %false
-            // 你的 IR 中 type 是 i1
-            std::string cond = label_or_cond; // i1
-            std::string val_name, l1_kw, l1, l2_kw, l2;
-            ss >> val_name; // %cond,
-            if(val_name.back()==',') val_name.pop_back();
-
-            ss >> l1_kw >> l1 >> l2_kw >> l2; // label %true, label %false
-            if(l1.back()==',') l1.pop_back();
-
-            // * 优化：先获取条件变量到寄存器，保存寄存器名后再 flush
-            int r_cond = getReg(val_name, false);
-            std::string cond_reg = getRegName(r_cond);
-            // 标记这个寄存器不需要 flush（即将用于 bne）
-            regs[r_cond].dirty = false;
-            flushRegisters(); // 跳转前写回（不会写回条件寄存器）
-            // * 优化：直接使用条件寄存器，不需要额外 move
-            emit("bne " + cond_reg + ", $zero, " + l1.substr(1));
-            emit("j " + l2.substr(1));
-        }
-    }
-    // 6. Void call 指令 (没有返回值的函数调用)
-    else if (token == "call") {
-        // call void @putint(i32 %3)
-        std::string ret_type, func_name;
-        ss >> ret_type >> func_name;
-        size_t p = func_name.find('(');
-        std::string real_name = func_name.substr(1, p-1);
-        std::string args_str = line.substr(line.find('(')+1);
-        if (!args_str.empty() && args_str.back() == ')') args_str.pop_back();
-
-        // * 修复：先收集所有参数值，避免参数计算时互相干扰
-        std::vector<std::string> arg_values;
-        std::stringstream arg_ss(args_str);
-        std::string segment;
-        while(std::getline(arg_ss, segment, ',')) {
-            std::stringstream seg_ss(segment);
-            std::string type, val;
-            seg_ss >> type >> val;
-            if (!val.empty()) {
-                arg_values.push_back(val);
-            }
-        }
-
-        // * 先计算所有参数值并保存到栈上的临时位置
-        std::vector<int> arg_stack_offsets;
-        int temp_arg_base = current_stack_offset - 100;
-        for (int i = 0; i < (int)arg_values.size() && i < 4; ++i) {
-            int r = getReg(arg_values[i], false);
-            int offset = temp_arg_base - i * 4;
-            emitStoreWord(getRegName(r), offset, "$fp");
-            arg_stack_offsets.push_back(offset);
-        }
-
-        // Flush registers before call!
-        flushRegisters();
-
-        // * 从临时栈位置加载参数到 $a0-$a3
-        for (int i = 0; i < (int)arg_stack_offsets.size() && i < 4; ++i) {
-            std::string arg_reg = "$a" + std::to_string(i);
-            emitLoadWord(arg_reg, arg_stack_offsets[i], "$fp");
-        }
-
-        if (real_name == "putint") {
-            emit("li $v0, 1");
-            emit("syscall");
-        }
-        else if (real_name == "putstr") {
-            emit("li $v0, 4");
-            emit("syscall");
-        }
-        else if (real_name == "putch") {
-            emit("li $v0, 11");
-            emit("syscall");
-        }
-        else {
-            emit("jal " + real_name);
-        }
-    }
-}
\ No newline at end of file
+//
+// Created by W on 2025/11/26.
+//
+
+#include "MipsGenerator.h"
+#include "IRModule.h"
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+std::string current_function_name;
+
+// * 寄存器划分：索引 [0, ALLOC_REG_END) 参与全局分配，[ALLOC_REG_END, 10) 作为 LRU 缓存
+static const int ALLOC_REG_END = 8;
+// * 被调用者保存的 $s0-$s7 对应索引 [SAVED_REG_BEGIN, SAVED_REG_END)，优先分配给跨调用活跃的值
+static const int SAVED_REG_BEGIN = 10;
+static const int SAVED_REG_END = 18;
+
+MipsGenerator::MipsGenerator(const IRModule& ir_module, const std::string& mips_path) : module(ir_module) {
+    mips_file.open(mips_path);
+    current_stack_offset = 0;
+    time_counter = 0;
+    current_instr_index = 0;
+    phi_edge_count = 0;
+    omit_frame_pointer = false;
+    frame_bias = 0;
+    current_func_lines = nullptr;
+    current_function_name = "";
+
+    // 初始化寄存器状态
+    for(int i=0; i<10; i++) {
+        regs[i].busy = false;
+        regs[i].dirty = false;
+        regs[i].last_use = 0;
+    }
+}
+
+MipsGenerator::~MipsGenerator() {
+    if (mips_file.is_open()) mips_file.close();
+}
+
+void MipsGenerator::emit(const std::string& asm_code) {
+    func_body << "    " << asm_code << "\n";
+}
+
+// 检查偏移是否在 16 位有符号立即数范围内
+static bool isSmallOffset(int offset) {
+    return offset >= -32768 && offset <= 32767;
+}
+
+// 生成 lw 指令，处理大偏移
+void MipsGenerator::emitLoadWord(const std::string& dest_reg, int offset, const std::string& base_reg) {
+    if (omit_frame_pointer && base_reg == "$fp") {
+        return emitLoadWord(dest_reg, offset + frame_bias, "$sp");
+    }
+    if (isSmallOffset(offset)) {
+        emit("lw " + dest_reg + ", " + std::to_string(offset) + "(" + base_reg + ")");
+    } else {
+        // 大偏移：使用 $v1 作为临时寄存器 (不使用 $at，因为 SPIM 保留)
+        emit("li $v1, " + std::to_string(offset));
+        emit("addu $v1, " + base_reg + ", $v1");
+        emit("lw " + dest_reg + ", 0($v1)");
+    }
+}
+
+// 生成 sw 指令，处理大偏移
+void MipsGenerator::emitStoreWord(const std::string& src_reg, int offset, const std::string& base_reg) {
+    if (omit_frame_pointer && base_reg == "$fp") {
+        return emitStoreWord(src_reg, offset + frame_bias, "$sp");
+    }
+    if (isSmallOffset(offset)) {
+        emit("sw " + src_reg + ", " + std::to_string(offset) + "(" + base_reg + ")");
+    } else {
+        // 大偏移：使用 $v1 作为临时寄存器 (不使用 $at，因为 SPIM 保留)
+        emit("li $v1, " + std::to_string(offset));
+        emit("addu $v1, " + base_reg + ", $v1");
+        emit("sw " + src_reg + ", 0($v1)");
+    }
+}
+
+// 生成地址加载指令 (addiu)，处理大偏移
+void MipsGenerator::emitLoadAddress(const std::string& dest_reg, int offset, const std::string& base_reg) {
+    if (omit_frame_pointer && base_reg == "$fp") {
+        return emitLoadAddress(dest_reg, offset + frame_bias, "$sp");
+    }
+    if (isSmallOffset(offset)) {
+        emit("addiu " + dest_reg + ", " + base_reg + ", " + std::to_string(offset));
+    } else {
+        // 大偏移：使用 li + addu
+        emit("li " + dest_reg + ", " + std::to_string(offset));
+        emit("addu " + dest_reg + ", " + base_reg + ", " + dest_reg);
+    }
+}
+
+// alloca 分配的字节数：[N x i32] 为 4N，标量为 4
+static int allocaSize(const std::string& type) {
+    if (type.empty() || type[0] != '[') return 4;
+    return std::stoi(type.substr(1, type.find('x') - 1)) * 4;
+}
+
+bool MipsGenerator::isNumber(const std::string& s) {
+    if (s.empty()) return false;
+    size_t start = 0;
+    if (s[0] == '-' || s[0] == '+') start = 1;
+    for (size_t i = start; i < s.size(); ++i) {
+        if (!isdigit(s[i])) return false;
+    }
+    return true;
+}
+
+// * 判断是否为临时变量（%0, %1 等数字开头的变量）
+static bool isTempVar(const std::string& name) {
+    if (name.empty() || name[0] != '%') return false;
+    if (name.length() < 2) return false;
+    return isdigit(name[1]);
+}
+
+// * 检查立即数是否在 16 位有符号范围内（可用于 addiu, ori 等）
+bool MipsGenerator::isSmallImmediate(int val) {
+    return val >= -32768 && val <= 32767;
+}
+
+// * 预分析函数，统计变量使用次数（死代码已在中端删除，这里用于判断比较能否与跳转融合）
+void MipsGenerator::preAnalyzeFunction(const std::vector<FuncLine>& instructions) {
+    var_use_count.clear();
+    for (const auto& line : instructions) {
+        if (line.inst == nullptr) continue;
+        for (const auto& operand : line.inst->operands) {
+            if (!operand.empty() && operand[0] == '%') var_use_count[operand]++;
+        }
+    }
+}
+
+// * 一条 IR 指令中的定义与使用（只关心 % 开头的局部值），跳转目标单独放入 targets
+static void decodeDefUse(const IRInst& inst, std::string& def,
+                         std::vector<std::string>& uses, std::vector<std::string>& targets) {
+    def = inst.dest;
+    uses.clear();
+    targets.clear();
+    for (const auto& operand : inst.operands) {
+        if (!operand.empty() && operand[0] == '%') uses.push_back(operand);
+    }
+    if (inst.opcode == IROpcode::Br || inst.opcode == IROpcode::CondBr) targets = inst.labels;
+}
+
+// * 全局寄存器分配：在 func_lines 上划分基本块、做活跃变量分析，
+// 计算每个 SSA 值的活跃区间，再按循环深度加权的溢出代价做线性扫描分配
+void MipsGenerator::allocateRegisters(const std::vector<FuncLine>& instructions,
+                                      const std::vector<std::string>& arg_names) {
+    reg_assign.clear();
+    call_live_across.clear();
+    phi_copies.clear();
+    int n = (int)instructions.size();
+    live_after.assign(n, {});
+
+    // 1. 解码指令：0 普通指令, 1 标签, 2 终结指令 (br/ret), 3 函数调用
+    // phi 的入边值不算本条指令的使用，而是在对应前驱块末尾使用
+    std::vector<int> kind(n, 0);
+    std::vector<std::string> defs(n);
+    std::vector<std::vector<std::string>> uses(n), targets(n);
+    std::map<int, std::vector<std::pair<std::string, std::string>>> phi_incoming;
+    std::set<std::string> allocas; // alloca 的结果是栈地址，不参与分配
+    for (int i = 0; i < n; ++i) {
+        const IRInst* inst = instructions[i].inst;
+        if (inst == nullptr) {
+            kind[i] = 1;
+            continue;
+        }
+        decodeDefUse(*inst, defs[i], uses[i], targets[i]);
+        if (inst->isTerminator()) {
+            kind[i] = 2;
+        } else if (inst->opcode == IROpcode::Call) {
+            if (!isBuiltinFunction(inst->callee)) kind[i] = 3;
+        } else if (inst->opcode == IROpcode::Alloca) {
+            allocas.insert(defs[i]);
+        } else if (inst->opcode == IROpcode::Phi) {
+            uses[i].clear();
+            for (size_t k = 0; k < inst->operands.size(); ++k) {
+                phi_incoming[i].push_back({inst->operands[k], inst->labels[k]});
+            }
+        }
+    }
+
+    // 2. 划分基本块（标签开始新块，终结指令结束当前块）
+    struct Block {
+        int begin, end;
+        std::vector<int> succ;
+        std::set<std::string> use, def, live_in, live_out;
+        int depth;
+    };
+    std::vector<Block> blocks;
+    std::map<std::string, int> label_block;
+    int start = 0;
+    for (int i = 0; i < n; ++i) {
+        if (kind[i] == 1) {
+            if (i > start) {
+                blocks.push_back({start, i - 1});
+                start = i;
+            }
+            label_block[instructions[i].label] = (int)blocks.size();
+        } else if (kind[i] == 2) {
+            blocks.push_back({start, i});
+            start = i + 1;
+        }
+    }
+    if (start < n) blocks.push_back({start, n - 1});
+    int nb = (int)blocks.size();
+    if (nb == 0) return;
+
+    std::vector<int> block_of(n, 0);
+    for (int b = 0; b < nb; ++b) {
+        Block& blk = blocks[b];
+        blk.depth = 0;
+        for (int i = blk.begin; i <= blk.end; ++i) block_of[i] = b;
+        if (kind[blk.end] == 2) {
+            for (const auto& t : targets[blk.end]) {
+                if (label_block.count(t)) blk.succ.push_back(label_block[t]);
+            }
+        } else if (b + 1 < nb) {
+            blk.succ.push_back(b + 1); // 顺序落入下一个块
+        }
+    }
+
+    auto is_candidate = [&](const std::string& v) { return !allocas.count(v); };
+
+    // phi 的入边值在前驱块末尾使用；同时记录每条边上需要的拷贝
+    std::vector<std::set<std::string>> phi_out(nb);
+    std::vector<std::string> block_label(nb);
+    for (const auto& item : label_block) block_label[item.second] = item.first;
+    for (const auto& item : phi_incoming) {
+        for (const auto& in : item.second) {
+            auto pred = label_block.find(in.second);
+            if (pred == label_block.end()) continue;
+            if (!isNumber(in.first) && is_candidate(in.first)) phi_out[pred->second].insert(in.first);
+            phi_copies[{in.second, block_label[block_of[item.first]]}].push_back({defs[item.first], in.first});
+        }
+    }
+
+    // 3. 活跃变量分析
+    for (auto& blk : blocks) {
+        for (int i = blk.begin; i <= blk.end; ++i) {
+            for (const auto& u : uses[i]) {
+                if (is_candidate(u) && !blk.def.count(u)) blk.use.insert(u);
+            }
+            if (!defs[i].empty() && is_candidate(defs[i])) blk.def.insert(defs[i]);
+        }
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = nb - 1; b >= 0; --b) {
+            Block& blk = blocks[b];
+            std::set<std::string> out = phi_out[b];
+            for (int s : blk.succ) out.insert(blocks[s].live_in.begin(), blocks[s].live_in.end());
+            std::set<std::string> in = blk.use;
+            for (const auto& v : out) {
+                if (!blk.def.count(v)) in.insert(v);
+            }
+            if (out != blk.live_out || in != blk.live_in) {
+                blk.live_out = std::move(out);
+                blk.live_in = std::move(in);
+                changed = true;
+            }
+        }
+    }
+
+    // 4. 循环深度：DFS 找回边，按循环头合并自然循环
+    std::vector<int> state(nb, 0); // 0 未访问, 1 在栈上, 2 已完成
+    std::map<int, std::vector<int>> back_edges; // 循环头 -> 回边源
+    std::vector<std::pair<int, size_t>> dfs_stack;
+    dfs_stack.push_back({0, 0});
+    state[0] = 1;
+    while (!dfs_stack.empty()) {
+        int b = dfs_stack.back().first;
+        size_t& next = dfs_stack.back().second;
+        if (next < blocks[b].succ.size()) {
+            int s = blocks[b].succ[next++];
+            if (state[s] == 0) {
+                state[s] = 1;
+                dfs_stack.push_back({s, 0});
+            } else if (state[s] == 1) {
+                back_edges[s].push_back(b);
+            }
+        } else {
+            state[b] = 2;
+            dfs_stack.pop_back();
+        }
+    }
+    if (!back_edges.empty()) {
+        std::vector<std::vector<int>> preds(nb);
+        for (int b = 0; b < nb; ++b) {
+            for (int s : blocks[b].succ) preds[s].push_back(b);
+        }
+        for (const auto& loop : back_edges) {
+            std::set<int> body = {loop.first};
+            std::vector<int> work = loop.second;
+            while (!work.empty()) {
+                int b = work.back();
+                work.pop_back();
+                if (!body.insert(b).second) continue;
+                for (int p : preds[b]) work.push_back(p);
+            }
+            for (int b : body) blocks[b].depth++;
+        }
+    }
+
+    // 5. 计算活跃区间与溢出代价
+    std::map<std::string, LiveInterval> intervals;
+    auto touch = [&](const std::string& v, int pos, double weight) {
+        auto it = intervals.find(v);
+        if (it == intervals.end()) {
+            intervals[v] = {v, pos, pos, weight, -1};
+        } else {
+            it->second.start = std::min(it->second.start, pos);
+            it->second.end = std::max(it->second.end, pos);
+            it->second.cost += weight;
+        }
+    };
+    for (const auto& arg : arg_names) touch(arg, -1, 1.0);
+    for (int i = 0; i < n; ++i) {
+        double weight = std::pow(10.0, std::min(blocks[block_of[i]].depth, 6));
+        for (const auto& u : uses[i]) {
+            if (is_candidate(u)) touch(u, 2 * i, weight);
+        }
+        if (!defs[i].empty() && is_candidate(defs[i])) touch(defs[i], 2 * i + 1, weight);
+    }
+    for (int b = 0; b < nb; ++b) {
+        const Block& blk = blocks[b];
+        for (const auto& v : blk.live_in) touch(v, 2 * blk.begin, 0.0);
+        // 只被 phi 拷贝使用的值活跃到终结指令为止，phi 结果从前驱末尾开始活跃
+        std::set<std::string> real_out;
+        for (int s : blk.succ) real_out.insert(blocks[s].live_in.begin(), blocks[s].live_in.end());
+        for (const auto& v : blk.live_out) touch(v, real_out.count(v) ? 2 * blk.end + 1 : 2 * blk.end, 0.0);
+    }
+    for (const auto& item : phi_incoming) {
+        for (const auto& in : item.second) {
+            auto pred = label_block.find(in.second);
+            if (pred == label_block.end()) continue;
+            const Block& blk = blocks[pred->second];
+            double weight = std::pow(10.0, std::min(blk.depth, 6));
+            touch(defs[item.first], 2 * blk.end + 1, weight);
+            if (phi_out[pred->second].count(in.first)) touch(in.first, 2 * blk.end, weight);
+        }
+    }
+
+    // 6. 记录每个调用点之后仍活跃的变量，用于调用前后保存/恢复寄存器；
+    // 同时记下每条指令之后的活跃集合，供缓存寄存器的写回与释放使用
+    for (const auto& blk : blocks) {
+        std::set<std::string> live = blk.live_out;
+        for (int i = blk.end; i >= blk.begin; --i) {
+            live_after[i] = live;
+            if (!defs[i].empty()) live.erase(defs[i]);
+            if (kind[i] == 3) call_live_across[i] = std::vector<std::string>(live.begin(), live.end());
+            for (const auto& u : uses[i]) {
+                if (is_candidate(u)) live.insert(u);
+            }
+        }
+    }
+    std::set<std::string> crosses_call;
+    for (const auto& item : call_live_across) crosses_call.insert(item.second.begin(), item.second.end());
+
+    // 7. 线性扫描：跨调用活跃的值优先用 $s 寄存器，其余优先用 $t 寄存器；
+    // 寄存器不足时溢出代价最小的区间
+    std::vector<LiveInterval*> order;
+    for (auto& item : intervals) order.push_back(&item.second);
+    std::sort(order.begin(), order.end(), [](const LiveInterval* a, const LiveInterval* b) {
+        if (a->start != b->start) return a->start < b->start;
+        return a->name < b->name;
+    });
+    std::vector<LiveInterval*> active;
+    std::set<int> free_regs;
+    for (int r = 0; r < ALLOC_REG_END; ++r) free_regs.insert(r);
+    for (int r = SAVED_REG_BEGIN; r < SAVED_REG_END; ++r) free_regs.insert(r);
+    for (LiveInterval* cur : order) {
+        for (auto it = active.begin(); it != active.end();) {
+            if ((*it)->end < cur->start) {
+                free_regs.insert((*it)->reg);
+                it = active.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!free_regs.empty()) {
+            bool want_saved = crosses_call.count(cur->name) > 0;
+            auto pick = want_saved ? free_regs.lower_bound(SAVED_REG_BEGIN) : free_regs.begin();
+            if (pick == free_regs.end() || (*pick >= SAVED_REG_BEGIN) != want_saved) {
+                pick = want_saved ? free_regs.begin() : free_regs.lower_bound(SAVED_REG_BEGIN);
+            }
+            cur->reg = *pick;
+            free_regs.erase(pick);
+            active.push_back(cur);
+            continue;
+        }
+        LiveInterval* victim = cur;
+        for (LiveInterval* a : active) {
+            if (a->cost < victim->cost || (a->cost == victim->cost && a->end > victim->end)) {
+                victim = a;
+            }
+        }
+        if (victim != cur) {
+            cur->reg = victim->reg;
+            victim->reg = -1;
+            *std::find(active.begin(), active.end(), victim) = cur;
+        }
+    }
+    used_saved_regs.clear();
+    for (const auto& item : intervals) {
+        if (item.second.reg < 0) continue;
+        reg_assign[item.first] = item.second.reg;
+        if (item.second.reg >= SAVED_REG_BEGIN) used_saved_regs.insert(item.second.reg);
+    }
+}
+
+std::string MipsGenerator::getRegName(int index) {
+    if (index >= SAVED_REG_BEGIN) return "$s" + std::to_string(index - SAVED_REG_BEGIN);
+    return "$t" + std::to_string(index);
+}
+
+// 分配栈空间（如果尚未分配）
+void MipsGenerator::allocStack(const std::string& var_name, int size) {
+    if (stack_map.find(var_name) == stack_map.end()) {
+        current_stack_offset -= size;
+        stack_map[var_name] = current_stack_offset;
+    }
+}
+
+int MipsGenerator::getStackOffset(const std::string& var_name) {
+    if (stack_map.find(var_name) == stack_map.end()) {
+        allocStack(var_name); // 兜底分配
+    }
+    return stack_map[var_name];
+}
+
+// --- 寄存器分配核心 ---
+
+// 溢出策略：LRU (Least Recently Used)
+int MipsGenerator::spillReg() {
+    int victim = -1;
+    int min_time = INT_MAX;
+
+    // 找到 last_use 最小的寄存器
+    for (int i = ALLOC_REG_END; i < 10; ++i) {
+        if (regs[i].busy && regs[i].last_use < min_time) {
+            min_time = regs[i].last_use;
+            victim = i;
+        }
+    }
+
+    if (victim == -1) {
+        // 理论上不会发生，除非所有寄存器都空（逻辑错误）
+        return ALLOC_REG_END;
+    }
+
+    // 执行溢出操作
+    std::string var = regs[victim].name;
+    // * alloca 变量不需要溢出（它的值是地址，是常量）
+    if (regs[victim].dirty && !(is_alloca_var.count(var) && is_alloca_var[var])) {
+        int offset = getStackOffset(var);
+        emitStoreWord(getRegName(victim), offset, "$fp");
+        emit("# Spill " + var);
+    }
+
+    // 清理状态
+    var_in_reg.erase(var);
+    regs[victim].busy = false;
+    regs[victim].dirty = false;
+
+    return victim;
+}
+
+int MipsGenerator::findFreeReg() {
+    for (int i = ALLOC_REG_END; i < 10; ++i) {
+        if (!regs[i].busy) return i;
+    }
+    return -1;
+}
+
+// 获取寄存器
+// var_name: 变量名或立即数
+// is_def: 是否是定义的变量（即作为赋值目标）。如果是，不需要从内存加载旧值。
+// is_addr: 特殊标记，如果是 store 的地址部分，确保它在寄存器
+int MipsGenerator::getReg(const std::string& var_name, bool is_def, bool is_addr) {
+    time_counter++;
+
+    // 1. 如果是数字立即数
+    // 我们分配一个临时寄存器装载它，通常不记录在 var_in_reg 中，用完即扔（或者可以优化）
+    // 为了简化 LRU 逻辑，这里我们也将其视为普通变量，但名字要是唯一的（防止冲突）
+    if (isNumber(var_name)) {
+        int val = std::stoi(var_name);
+        // * 优化：0 可以直接使用 $zero 寄存器的值
+        int reg = findFreeReg();
+        if (reg == -1) reg = spillReg();
+
+        if (val == 0) {
+            emit("move " + getRegName(reg) + ", $zero");
+        } else {
+            emit("li " + getRegName(reg) + ", " + var_name);
+        }
+        // 数字不占用 var_in_reg 映射，只是临时占用寄存器
+        regs[reg].busy = true;
+        regs[reg].name = ""; // 匿名
+        regs[reg].dirty = false;
+        regs[reg].last_use = time_counter;
+        return reg;
+    }
+
+    // * 全局分配到寄存器的变量常驻寄存器，无需加载/写回
+    auto assigned = reg_assign.find(var_name);
+    if (assigned != reg_assign.end()) {
+        return assigned->second;
+    }
+
+    // 2. 如果变量已经在寄存器中
+    if (var_in_reg.count(var_name)) {
+        int reg = var_in_reg[var_name];
+        regs[reg].last_use = time_counter;
+        if (is_def) regs[reg].dirty = true; // 如果这次是写操作，标记为脏
+        return reg;
+    }
+
+    // 3. 需要分配新寄存器
+    int reg = findFreeReg();
+    if (reg == -1) reg = spillReg();
+
+    // 4. 占用寄存器
+    regs[reg].busy = true;
+    regs[reg].name = var_name;
+    regs[reg].last_use = time_counter;
+    var_in_reg[var_name] = reg;
+
+    // 5. 如果是读操作（不是定义），则从栈加载旧值
+    if (!is_def) {
+        if (var_name[0] == '@') {
+            // 【处理全局变量/常量 (@)】
+            std::string raw_label = var_name.substr(1);
+            // 字符串常量以 .str 开头不需要前缀，其他全局变量需要 _ 前缀
+            std::string global_label = (raw_label[0] == '.') ? raw_label : ("_" + raw_label);
+            if (is_addr) {
+                // 只取地址（用于 load/store 指令的指针操作数）
+                emit("la " + getRegName(reg) + ", " + global_label + " # Load Global Address of " + var_name);
+            } else {
+                // 取值（用于普通表达式）
+                emit("la " + getRegName(reg) + ", " + global_label + " # Load Global Address of " + var_name);
+                emit("lw " + getRegName(reg) + ", 0(" + getRegName(reg) + ") # Load Global Value " + var_name);
+            }
+            regs[reg].dirty = false;
+        } else if (is_alloca_var.count(var_name) && is_alloca_var[var_name]) {
+            // * alloca 变量：其值是地址，计算 $fp + offset
+            int offset = getStackOffset(var_name);
+            emitLoadAddress(getRegName(reg), offset, "$fp");
+            emit("# Address of " + var_name);
+            regs[reg].dirty = false;
+        } else {
+            // 普通局部变量/临时变量: 从栈加载值
+            int offset = getStackOffset(var_name);
+            emitLoadWord(getRegName(reg), offset, "$fp");
+            emit("# Load " + var_name);
+            regs[reg].dirty = false;
+        }
+    } else {
+        // 定义操作，标记为 dirty
+        // ! 不能用单次使用优化，因为 flush 会导致问题
+        regs[reg].dirty = true;
+    }
+    return reg;
+}
+
+// 当前指令之后 var 是否仍活跃（没有活跃信息时保守地视为活跃）
+bool MipsGenerator::isLiveAfterCurrent(const std::string& var) {
+    if (current_instr_index < 0 || current_instr_index >= (int)live_after.size()) return true;
+    if (var.empty() || var[0] != '%') return true;
+    return live_after[current_instr_index].count(var) > 0;
+}
+
+// * 释放缓存中当前指令之后不再活跃的值：寄存器直接空出，脏值也无需写回
+void MipsGenerator::releaseDeadRegisters() {
+    for (int i = ALLOC_REG_END; i < 10; ++i) {
+        if (!regs[i].busy) continue;
+        const std::string& var = regs[i].name;
+        if (!var.empty() && is_alloca_var.count(var) && is_alloca_var[var]) continue;
+        if (!var.empty() && isLiveAfterCurrent(var)) continue;
+        var_in_reg.erase(var);
+        regs[i].busy = false;
+        regs[i].dirty = false;
+        regs[i].name = "";
+    }
+}
+
+// 强制写回所有脏寄存器（在跳转、函数调用、Label前调用）
+// * 只写回当前指令之后仍活跃的值，块内即死的临时值直接丢弃
+void MipsGenerator::flushRegisters() {
+    for (int i = ALLOC_REG_END; i < 10; ++i) {
+        if (regs[i].busy) {
+            // * alloca 变量不需要写回（它的值是地址，是常量）
+            if (regs[i].dirty && !regs[i].name.empty() && isLiveAfterCurrent(regs[i].name) &&
+                !(is_alloca_var.count(regs[i].name) && is_alloca_var[regs[i].name])) {
+                int offset = getStackOffset(regs[i].name);
+                emitStoreWord(getRegName(i), offset, "$fp");
+                emit("# Flush " + regs[i].name);
+            }
+            regs[i].busy = false;
+            regs[i].dirty = false;
+            regs[i].name = "";
+        }
+    }
+    var_in_reg.clear();
+}
+
+// --- 流程控制 ---
+
+void MipsGenerator::generate() {
+    if (!mips_file.is_open()) return;
+
+    mips_file << ".data\n";
+    parseGlobalVars();
+
+    mips_file << "\n.text\n";
+    mips_file << "jal main\n";
+    mips_file << "li $v0, 10\nsyscall\n";
+
+    parseFunctions();
+}
+
+void MipsGenerator::parseGlobalVars() {
+    // 解析全局变量和常量数组（中端原样保留的全局定义行）
+    for (const std::string& line : module.globals) {
+        // * 处理全局变量: @name = global i32 0, align 4
+        // 注意：排除字符串常量（@.str 开头）
+        if (line.find("@") == 0 && line.find("@.str") == std::string::npos && line.find("= global") != std::string::npos) {
+            std::stringstream ss(line);
+            std::string name_token;
+            ss >> name_token;
+            std::string name = name_token.substr(1);
+            // 添加下划线前缀，避免与 MIPS 指令名（如 b, j）冲突
+            mips_file << "_" << name << ": ";
+
+            if (line.find("zeroinitializer") != std::string::npos) {
+                // 数组零初始化，解析 [N x i32]
+                size_t bracket_start = line.find('[');
+                size_t x_pos = line.find('x');
+                if (bracket_start != std::string::npos && x_pos != std::string::npos) {
+                    int num = std::stoi(line.substr(bracket_start + 1, x_pos - bracket_start - 1));
+                    mips_file << ".word 0:" << num << "\n";
+                } else {
+                    mips_file << ".word 0\n";
+                }
+            } else if (line.find("] [") != std::string::npos) {
+                // * 带初始化列表的数组: @arr = global [N x i32] [i32 10, i32 25, ...], align 4
+                size_t init_start = line.find("] [");
+                if (init_start != std::string::npos) {
+                    init_start += 3; // 跳过 "] ["
+                    size_t init_end = line.find("]", init_start);
+                    std::string init_list = line.substr(init_start, init_end - init_start);
+
+                    // 解析 i32 N, i32 M, ...
+                    std::vector<int> values;
+                    std::stringstream init_ss(init_list);
+                    std::string token;
+                    while (std::getline(init_ss, token, ',')) {
+                        size_t i32_pos = token.find("i32");
+                        if (i32_pos != std::string::npos) {
+                            std::string num_str = token.substr(i32_pos + 3);
+                            // 去除空格
+                            num_str.erase(0, num_str.find_first_not_of(" \t"));
+                            num_str.erase(num_str.find_last_not_of(" \t") + 1);
+                            if (!num_str.empty()) {
+                                values.push_back(std::stoi(num_str));
+                            }
+                        }
+                    }
+
+                    // 输出数组值 (SPIM 用逗号分隔)
+                    mips_file << ".word ";
+                    for (size_t i = 0; i < values.size(); ++i) {
+                        if (i > 0) mips_file << ", ";
+                        mips_file << values[i];
+                    }
+                    mips_file << "\n";
+                }
+            } else {
+                // * 简单标量初始化: @c = global i32 3, align 4
+                // 解析 "global i32 <value>" 中的 value
+                size_t i32_pos = line.find("i32 ");
+                if (i32_pos != std::string::npos) {
+                    std::string rest = line.substr(i32_pos + 4);
+                    // 提取数字直到逗号或空格
+                    size_t end = rest.find_first_of(", ");
+                    std::string value_str = rest.substr(0, end);
+                    // 去除前后空格
+                    value_str.erase(0, value_str.find_first_not_of(" \t"));
+                    value_str.erase(value_str.find_last_not_of(" \t") + 1);
+                    mips_file << ".word " << value_str << "\n";
+                } else {
+                    mips_file << ".word 0\n";
+                }
+            }
+        }
+        // * 处理常量数组: @ia1_9 = constant [5 x i32] [i32 1, i32 2, ...], align 4
+        // ! 注意：不能以 @.str 开头（那是字符串常量）
+        else if (line.find("@") == 0 && line.find("@.str") == std::string::npos && line.find("constant") != std::string::npos && line.find("x i32]") != std::string::npos) {
+            std::stringstream ss(line);
+            std::string name_token;
+            ss >> name_token;
+            std::string name = name_token.substr(1);
+            // 添加下划线前缀，避免与 MIPS 指令名冲突
+            mips_file << "_" << name << ": .word ";
+
+            // 提取数组初始化值 [i32 1, i32 2, i32 3, ...]
+            size_t init_start = line.find("] [");
+            if (init_start != std::string::npos) {
+                init_start += 3; // 跳过 "] ["
+                size_t init_end = line.find("]", init_start);
+                std::string init_list = line.substr(init_start, init_end - init_start);
+
+                // 解析 i32 N, i32 M, ...
+                std::vector<int> values;
+                std::stringstream init_ss(init_list);
+                std::string token;
+                while (std::getline(init_ss, token, ',')) {
+                    size_t i32_pos = token.find("i32");
+                    if (i32_pos != std::string::npos) {
+                        std::string num_str = token.substr(i32_pos + 3);
+                        // 去除空格
+                        num_str.erase(0, num_str.find_first_not_of(" \t"));
+                        num_str.erase(num_str.find_last_not_of(" \t") + 1);
+                        if (!num_str.empty()) {
+                            values.push_back(std::stoi(num_str));
+                        }
+                    }
+                }
+
+                // 输出数组值 (SPIM 用逗号分隔)
+                for (size_t i = 0; i < values.size(); ++i) {
+                    if (i > 0) mips_file << ", ";
+                    mips_file << values[i];
+                }
+                mips_file << "\n";
+            }
+        }
+        // * 处理字符串常量: @.str = private unnamed_addr constant [6 x i8] c"crsb\0A\00", align 1
+        else if (line.find("@.str") != std::string::npos && line.find("constant") != std::string::npos) {
+            // 字符串常量处理：@.str = private unnamed_addr constant [6 x i8] c"crsb\0A\00", align 1
+            std::stringstream ss(line);
+            std::string name;
+            ss >> name;
+            mips_file << name.substr(1) << ": .asciiz ";
+
+            // 找到字符串部分：c"..."
+            size_t c_start = line.find("c\"");
+            size_t c_end = line.rfind('\"');
+
+            if (c_start != std::string::npos && c_end != std::string::npos && c_end > c_start) {
+                // 提取 c"..." 中的内容，跳过 c"
+                std::string raw_content = line.substr(c_start + 2, c_end - (c_start + 2));
+
+                std::string processed_content = "\"";
+                for (size_t i = 0; i < raw_content.length(); ++i) {
+                    if (raw_content[i] == '\\' && i + 2 < raw_content.length()) {
+                        // 处理转义序列，如 \0A, \00
+                        std::string hex = raw_content.substr(i + 1, 2);
+                        if (hex == "0A") {
+                            processed_content += "\\n"; // LLVM \0A -> MIPS \n
+                            i += 2;
+                        } else if (hex == "09") {
+                            processed_content += "\\t"; // LLVM \09 -> MIPS \t
+                            i += 2;
+                        } else if (hex == "00") {
+                            // \00 是字符串结束符，.asciiz 会自动添加
+                            i += 2;
+                            continue;
+                        } else {
+                            // 如果是其他转义，保持原样 (不推荐，但作为兜底)
+                            processed_content += raw_content[i];
+                        }
+                    } else {
+                        processed_content += raw_content[i];
+                    }
+                }
+                processed_content += "\"";
+                mips_file << processed_content << "\n";
+            }
+        }
+    }
+}
+
+void MipsGenerator::parseFunctions() {
+    for (const IRFunction& func : module.functions) {
+        // * 缓存当前函数的所有指令：每个基本块先放标签行，再放块内指令
+        std::vector<FuncLine> func_lines;
+        for (const IRBlock& block : func.blocks) {
+            func_lines.push_back({block.label, nullptr});
+            for (const IRInst& inst : block.insts) func_lines.push_back({"", &inst});
+        }
+
+        // * 预分析函数内所有指令
+        preAnalyzeFunction(func_lines);
+
+        current_instr_index = -1;
+        flushRegisters(); // 安全起见
+        stack_map.clear();
+        is_alloca_var.clear(); // 清空 alloca 标记
+        current_stack_offset = 0;
+
+        const std::string& func_name = func.name;
+        current_function_name = func_name;
+
+        std::vector<std::string> arg_names;
+        for (const auto& param : func.params) arg_names.push_back(param.second);
+
+        // * 全局寄存器分配
+        allocateRegisters(func_lines, arg_names);
+
+        // * 出参区：O32 约定下调用者在栈底为被调函数预留参数槽（前 4 个为 $a0-$a3 的归属槽）
+        int max_call_args = -1;
+        for (const auto& body_line : func_lines) {
+            const IRInst* inst = body_line.inst;
+            if (inst == nullptr || inst->opcode != IROpcode::Call || isBuiltinFunction(inst->callee)) continue;
+            max_call_args = std::max(max_call_args, (int)inst->operands.size());
+        }
+        int outgoing_area = max_call_args < 0 ? 0 : 4 * std::max(max_call_args, 4);
+
+        // * 两阶段生成：先把函数体翻译到缓冲区，得到最终的 current_stack_offset 后再生成序言
+        func_body.str("");
+        current_stack_offset = -8;    // 局部变量从 $fp-12 开始（跳过保存区）
+
+        // * 叶函数（不调用用户函数）：不保存 $ra/$fp，局部变量改用 $sp 寻址
+        // 预先为所有 alloca 与未分配寄存器的值分配栈槽，帧大小在翻译函数体之前即可确定；
+        // 仍以“虚拟帧指针”（调用者的 $sp）为基准记录偏移，发射时统一加上 frame_bias
+        omit_frame_pointer = max_call_args < 0;
+        if (omit_frame_pointer) {
+            current_stack_offset = 0;
+            for (const auto& body_line : func_lines) {
+                const IRInst* inst = body_line.inst;
+                if (inst == nullptr || inst->dest.empty()) continue;
+                if (inst->opcode == IROpcode::Alloca) {
+                    allocStack(inst->dest, allocaSize(inst->type));
+                } else if (!reg_assign.count(inst->dest)) {
+                    allocStack(inst->dest);
+                }
+            }
+            if (func_name != "main") {
+                for (int r : used_saved_regs) allocStack(getRegName(r));
+            }
+            frame_bias = (-current_stack_offset + 7) / 8 * 8;
+        }
+
+        // * 保存本函数用到的 $s 寄存器（main 返回后直接退出，无需保存）
+        saved_reg_slots.clear();
+        if (func_name != "main") {
+            for (int r : used_saved_regs) {
+                allocStack(getRegName(r));
+                saved_reg_slots.push_back({r, getStackOffset(getRegName(r))});
+                emitStoreWord(getRegName(r), saved_reg_slots.back().second, "$fp");
+            }
+        }
+
+        // 处理函数参数: 第 i 个参数的栈槽在调用者出参区 4*i($fp)
+        // 前 4 个在 $a0-$a3 中：分配到寄存器的直接 move，其余写回归属槽；第 5 个起从栈槽读取
+        const char* arg_regs[] = {"$a0", "$a1", "$a2", "$a3"};
+        for (size_t i = 0; i < arg_names.size(); ++i) {
+            int slot = 4 * (int)i;
+            bool in_reg = reg_assign.count(arg_names[i]) > 0;
+            if (!in_reg) stack_map[arg_names[i]] = slot;
+            if (i < 4) {
+                if (in_reg) emit("move " + getRegName(reg_assign[arg_names[i]]) + ", " + arg_regs[i]);
+                else emitStoreWord(std::string(arg_regs[i]), slot, "$fp");
+            } else if (in_reg) {
+                emitLoadWord(getRegName(reg_assign[arg_names[i]]), slot, "$fp");
+            }
+        }
+
+        // * 处理函数体的所有指令
+        current_block_label = "entry";
+        current_func_lines = &func_lines;
+        skipped_instrs.clear();
+        fused_conditions.clear();
+        for (size_t i = 0; i < func_lines.size(); ++i) {
+            if (skipped_instrs.count((int)i)) continue;
+            current_instr_index = (int)i;
+            processInstruction(func_lines[i]);
+            // 与后续 br 融合的比较，其操作数要留到 br 处使用
+            // （icmp 直接接 br 时不跳过任何指令，只能从 fused_conditions 中识别）
+            const IRInst* inst = func_lines[i].inst;
+            bool fused_into_branch = skipped_instrs.count((int)i + 1) ||
+                                     (inst && inst->opcode == IROpcode::ICmp && fused_conditions.count(inst->dest));
+            if (!fused_into_branch) releaseDeadRegisters();
+        }
+
+        // Prologue
+        // 栈布局: $sp(原) -> [$fp saved], [$ra saved], [locals...], [出参区]
+        // 栈帧大小 = 局部变量区 + 出参区，连同保存区按 8 字节对齐
+        int frame_size = (-current_stack_offset - 8 + outgoing_area + 7) / 8 * 8;
+        std::string body = func_body.str();
+        func_body.str("");
+        if (omit_frame_pointer) {
+            // 叶函数只需分配局部变量区，帧为空时没有序言
+            if (frame_bias > 0) emit("subu $sp, $sp, " + std::to_string(frame_bias));
+        } else {
+            // 先减 $sp 为保存区腾出空间
+            emit("subu $sp, $sp, 8");     // 为 $fp 和 $ra 预留空间
+            emit("sw $fp, 4($sp)");       // 保存旧 $fp 在 $sp+4
+            emit("sw $ra, 0($sp)");       // 保存旧 $ra 在 $sp+0
+            emit("addiu $fp, $sp, 8");    // $fp 指向旧栈顶，局部变量从 $fp-12 开始
+            if (frame_size > 0) emit("subu $sp, $sp, " + std::to_string(frame_size));
+        }
+        mips_file << "\n" << func_name << ":\n" << func_body.str() << body;
+        func_body.str("");
+    }
+}
+
+void MipsGenerator::processInstruction(const FuncLine& line) {
+    // 1. Label (基本块入口)
+    // 必须 Flush，因为不知道从哪跳过来的
+    if (line.inst == nullptr) {
+        flushRegisters();
+        current_block_label = line.label;
+        if (line.label == "entry" || line.label == "0") {
+            return;
+        }
+        func_body << line.label << ":\n";
+        return;
+    }
+
+    const IRInst& inst = *line.inst;
+    const std::string& dest = inst.dest;
+    switch (inst.opcode) {
+        case IROpcode::Alloca:
+            // %1 = alloca [10 x i32]
+            // 分配栈空间，alloca 的结果是该空间的地址
+            allocStack(dest, allocaSize(inst.type));
+            // * 标记这个变量是 alloca 出来的，其值是地址
+            is_alloca_var[dest] = true;
+            break;
+        case IROpcode::Add:
+        case IROpcode::Sub:
+        case IROpcode::Mul:
+        case IROpcode::SDiv:
+        case IROpcode::SRem: {
+            // %2 = add nsw i32 %0, %1
+            static const char* names[] = {"add", "sub", "mul", "sdiv", "srem"};
+            std::string op = names[(int)inst.opcode - (int)IROpcode::Add];
+            std::string s1 = inst.operands[0], s2 = inst.operands[1];
+
+            bool handled = false;
+
+            // * 优化：sub 0, X 可以用 negu（取负）
+            if (op == "sub" && isNumber(s1) && std::stoi(s1) == 0) {
+                int r2 = getReg(s2, false);
+                int rd = getReg(dest, true);
+                emit("negu " + getRegName(rd) + ", " + getRegName(r2));
+                handled = true;
+            }
+            // * 优化：立即数形式指令
+            // add/sub 可以使用 addiu/subiu（MIPS 没有 subiu，用 addiu 负数）
+            if (!handled && op == "add" && isNumber(s2)) {
+                int imm = std::stoi(s2);
+                if (isSmallImmediate(imm)) {
+                    int r1 = getReg(s1, false);
+                    int rd = getReg(dest, true);
+                    emit("addiu " + getRegName(rd) + ", " + getRegName(r1) + ", " + s2);
+                    handled = true;
+                }
+            }
+            if (!handled && op == "sub" && isNumber(s2)) {
+                int imm = std::stoi(s2);
+                if (isSmallImmediate(-imm)) {
+                    int r1 = getReg(s1, false);
+                    int rd = getReg(dest, true);
+                    emit("addiu " + getRegName(rd) + ", " + getRegName(r1) + ", " + std::to_string(-imm));
+                    handled = true;
+                }
+            }
+            // * 优化：乘以常量时按代价改用移位与加减（乘以 0/1 直接折叠）
+            if (!handled && op == "mul" && isNumber(s1) && !isNumber(s2)) std::swap(s1, s2);
+            if (!handled && op == "mul" && isNumber(s2) && !isNumber(s1)) {
+                int imm = std::stoi(s2);
+                if (mulByConstantCost(imm) <= MUL_COST) {
+                    int r1 = getReg(s1, false);
+                    int rd = getReg(dest, true);
+                    emitMulByConstant(getRegName(rd), getRegName(r1), imm);
+                    handled = true;
+                }
+            }
+            // * 优化：除数为常量的 sdiv/srem 不用 div，改为移位或乘法（魔数）序列
+            if (!handled && (op == "sdiv" || op == "srem") && isNumber(s2) && !isNumber(s1)) {
+                int r1 = getReg(s1, false);
+                int rd = getReg(dest, true);
+                handled = emitDivByConstant(getRegName(rd), getRegName(r1), std::stoi(s2), op == "srem");
+            }
+
+            if (!handled) {
+                int r1 = getReg(s1, false);
+                int r2 = getReg(s2, false);
+                int rd = getReg(dest, true); // dest 是定义
+
+                std::string mips_op = "addu";
+                if (op == "sub") mips_op = "subu";
+                else if (op == "mul") mips_op = "mul";
+                else if (op == "sdiv") mips_op = "div";
+                else if (op == "srem") mips_op = "div"; // 取余也要 div
+
+                if (op == "sdiv") {
+                    emit("div " + getRegName(r1) + ", " + getRegName(r2));
+                    emit("mflo " + getRegName(rd));
+                } else if (op == "srem") {
+                    emit("div " + getRegName(r1) + ", " + getRegName(r2));
+                    emit("mfhi " + getRegName(rd));
+                } else {
+                    emit(mips_op + " " + getRegName(rd) + ", " + getRegName(r1) + ", " + getRegName(r2));
+                }
+            }
+            break;
+        }
+        case IROpcode::Load: {
+            // %0 = load i32, i32* %i_2_addr, align 4
+            // 指针地址 - 使用 is_addr=true，只取地址不取值
+            int r_ptr = getReg(inst.operands[0], false, true);
+            int r_dest = getReg(dest, true);
+            emit("lw " + getRegName(r_dest) + ", 0(" + getRegName(r_ptr) + ")");
+            break;
+        }
+        case IROpcode::ICmp: {
+            // %3 = icmp eq i32 %1, %2
+            std::string cond = inst.predicate, s1 = inst.operands[0], s2 = inst.operands[1];
+
+            // * 只被紧随其后的 br 使用的比较不生成布尔值，由 br 直接生成比较跳转
+            if ((inst.type == "i32" || inst.type == "i32*") && fuseCompareBranch(dest, cond, s1, s2)) return;
+
+            // * 只用原生的 slt/slti/sltu/sltiu/xor/xori 生成布尔值，不使用 seq/sne/sge 等伪指令
+            // 常量在左侧时交换操作数，使立即数总在右侧
+            // 无符号比较（ult/ule/ugt/uge，用于指针）按有符号谓词处理，只把 slt/slti 换成 sltu/sltiu
+            static const std::map<std::string, std::string> mirror = {
+                {"eq", "eq"}, {"ne", "ne"}, {"slt", "sgt"}, {"sgt", "slt"}, {"sle", "sge"}, {"sge", "sle"}};
+            bool is_unsigned = cond[0] == 'u';
+            if (is_unsigned) cond[0] = 's';
+            std::string lt = is_unsigned ? "sltu " : "slt ", lti = is_unsigned ? "sltiu " : "slti ";
+            if (isNumber(s1) && !isNumber(s2)) {
+                std::swap(s1, s2);
+                cond = mirror.at(cond);
+            }
+            bool s2_is_const = isNumber(s2);
+            long long imm = s2_is_const ? std::stoll(s2) : 0;
+            auto fitsSigned = [](long long v) { return v >= -32768 && v <= 32767; };
+            auto fitsUnsigned = [](long long v) { return v >= 0 && v <= 65535; };
+
+            // 源操作数须先于目标取寄存器，避免缓存寄存器被目标挤出
+            int r1 = getReg(s1, false);
+            bool s2_in_reg;
+            if (cond == "eq" || cond == "ne") s2_in_reg = !s2_is_const || (imm != 0 && !fitsUnsigned(imm));
+            else if (cond == "slt" || cond == "sge") s2_in_reg = !s2_is_const || !fitsSigned(imm);
+            else s2_in_reg = !s2_is_const || (imm != 0 && !fitsSigned(imm + 1)); // sgt/sle 与 imm + 1 比较
+            int r2 = s2_in_reg ? getReg(s2, false) : -1;
+            int rd = getReg(dest, true);
+            std::string a = getRegName(r1), d = getRegName(rd);
+            std::string b = s2_in_reg ? getRegName(r2) : "";
+
+            if (cond == "eq" || cond == "ne") {
+                // a == b  <=>  (a ^ b) < 1（无符号）；a != b  <=>  0 < (a ^ b)（无符号）
+                std::string diff = a;
+                if (s2_in_reg) { emit("xor " + d + ", " + a + ", " + b); diff = d; }
+                else if (imm != 0) { emit("xori " + d + ", " + a + ", " + std::to_string(imm)); diff = d; }
+                if (cond == "eq") emit("sltiu " + d + ", " + diff + ", 1");
+                else emit("sltu " + d + ", $zero, " + diff);
+            } else if (cond == "slt" || cond == "sge") {
+                // a >= b  <=>  !(a < b)
+                if (s2_in_reg) emit(lt + d + ", " + a + ", " + b);
+                else emit(lti + d + ", " + a + ", " + std::to_string(imm));
+                if (cond == "sge") emit("xori " + d + ", " + d + ", 1");
+            } else {
+                // a > b  <=>  b < a；a <= b  <=>  !(b < a)；与常量比较时改用 a < imm + 1
+                if (s2_in_reg || imm == 0) {
+                    emit(lt + d + ", " + (s2_in_reg ? b : "$zero") + ", " + a);
+                    if (cond == "sle") emit("xori " + d + ", " + d + ", 1");
+                } else {
+                    emit(lti + d + ", " + a + ", " + std::to_string(imm + 1));
+                    if (cond == "sgt") emit("xori " + d + ", " + d + ", 1");
+                }
+            }
+            break;
+        }
+        case IROpcode::GetElementPtr: {
+            // %4 = getelementptr inbounds [2 x i8], [2 x i8]* @.str0, i32 0, i32 0
+            // base 指针和最后一个 offset
+            const std::string& base = inst.operands[0];
+            const std::string& idx = inst.operands.back();
+
+            // 如果 base 是全局变量（@ 开头），直接 la 加载地址
+            if (base[0] == '@') {
+                std::string raw_label = base.substr(1);
+                // 字符串常量以 .str 开头不需要前缀，其他全局变量需要 _ 前缀
+                std::string label = (raw_label[0] == '.') ? raw_label : ("_" + raw_label);
+                // 对于字符串常量或数组，offset 通常是 0，直接 la 即可
+                if (isNumber(idx) && std::stoi(idx) == 0) {
+                    int r_dest = getReg(dest, true);
+                    emit("la " + getRegName(r_dest) + ", " + label);
+                } else if (isNumber(idx) && std::llabs(std::stoll(idx)) < 8192) {
+                    int r_dest = getReg(dest, true);
+                    emit("la " + getRegName(r_dest) + ", " + label);
+                    emit("addiu " + getRegName(r_dest) + ", " + getRegName(r_dest) + ", " + std::to_string(std::stoi(idx) * 4));
+                } else {
+                    // 非零 offset：计算 base + idx * element_size（$v1 作为临时寄存器）
+                    int r_idx = getReg(idx, false);
+                    int r_dest = getReg(dest, true);
+                    emit("sll $v1, " + getRegName(r_idx) + ", 2");
+                    emit("la " + getRegName(r_dest) + ", " + label);
+                    emit("addu " + getRegName(r_dest) + ", " + getRegName(r_dest) + ", $v1");
+                }
+            }
+            else if (isNumber(idx) && std::llabs(std::stoll(idx)) < 8192) {
+                // * 常量下标（如归纳指针的步进）直接 addiu
+                int r_base = getReg(base, false);
+                int r_dest = getReg(dest, true);
+                emit("addiu " + getRegName(r_dest) + ", " + getRegName(r_base) + ", " + std::to_string(std::stoi(idx) * 4));
+            }
+            else {
+                // 局部变量指针（$v1 作为临时寄存器，目标可能与 base 共用寄存器）
+                int r_base = getReg(base, false);
+                int r_idx = getReg(idx, false);
+                int r_dest = getReg(dest, true);
+                emit("sll $v1, " + getRegName(r_idx) + ", 2");
+                emit("addu " + getRegName(r_dest) + ", " + getRegName(r_base) + ", $v1");
+            }
+            break;
+        }
+        case IROpcode::Zext: {
+            // %2 = zext i1 %1 to i32
+            // MIPS 中不做区分，直接 move
+            int r_src = getReg(inst.operands[0], false);
+            int r_dst = getReg(dest, true);
+            // * 优化：源和目标相同时省略 move
+            if (r_src != r_dst) {
+                emit("move " + getRegName(r_dst) + ", " + getRegName(r_src));
+            }
+            break;
+        }
+        case IROpcode::Call:
+            // %3 = call i32 @func(...) 或 call void @putint(i32 %3)
+            processCall(inst);
+            break;
+        case IROpcode::Store: {
+            // store i1 %1, i1* %and_res4, align 1
+            int r_val = getReg(inst.operands[0], false);
+            int r_ptr = getReg(inst.operands[1], false, true);  // is_addr=true，只取地址不取值
+
+            emit("sw " + getRegName(r_val) + ", 0(" + getRegName(r_ptr) + ")");
+            break;
+        }
+        case IROpcode::Ret:
+            // * 优化：ret 前不需要 flush 局部变量，因为栈帧即将销毁
+            // 但需要先获取返回值（如果有）
+            if (!inst.operands.empty()) {
+                const std::string& val = inst.operands[0];
+                // * 优化：如果返回值是立即数，直接 li $v0
+                if (isNumber(val)) {
+                    int imm = std::stoi(val);
+                    if (imm == 0) {
+                        emit("move $v0, $zero");
+                    } else {
+                        emit("li $v0, " + val);
+                    }
+                } else {
+                    // 加载返回值到 $v0
+                    int r_val = getReg(val, false);
+                    emit("move $v0, " + getRegName(r_val));
+                }
+            }
+            // 不需要 flushRegisters()，栈帧即将销毁
+            emitEpilogue();
+            emit("jr $ra");
+            break;
+        case IROpcode::Br: {
+            flushRegisters(); // 无条件跳转前写回
+            const std::string& label = inst.labels[0];
+            emitPhiCopies(current_block_label, label);
+            // * 目标就是下一个块时直接落入
+            if (label != nextBlockLabel()) emit("j " + label);
+            break;
+        }
+        case IROpcode::CondBr: {
+            // br i1 %cond, label %true, label %false
+            const std::string& val_name = inst.operands[0];
+
+            // * 先确定“条件成立则跳转”的分支指令，寄存器取好后再 flush
+            // 与 icmp 融合的条件直接生成比较跳转，否则对条件寄存器做 bne
+            std::string branch_op, branch_args, compare;
+            auto fused = fused_conditions.find(val_name);
+            if (fused != fused_conditions.end()) {
+                lowerCompareBranch(fused->second[0], fused->second[1], fused->second[2],
+                                   branch_op, branch_args, compare);
+            } else {
+                int r_cond = getReg(val_name, false);
+                branch_op = "bne";
+                branch_args = getRegName(r_cond) + ", $zero";
+            }
+            flushRegisters(); // 跳转前写回（只写内存，不破坏已取到的寄存器）
+            if (!compare.empty()) emit(compare); // 比较结果放在 $v1，须在 flush 之后生成
+
+            // * 某个目标是下一个块时只生成一条分支，否则条件分支 + j
+            // 回边上的 phi 拷贝尽量提前到分支之前，分支直接跳回循环头；
+            // 其余真分支上的拷贝放到单独的拷贝块（IR 已拆分其他关键边，一般不会出现）
+            const std::string& true_label = inst.labels[0];
+            const std::string& false_label = inst.labels[1];
+            bool true_copies = phi_copies.count({current_block_label, true_label}) > 0;
+            bool false_copies = phi_copies.count({current_block_label, false_label}) > 0;
+            if (true_copies && canHoistPhiCopies(true_label, false_label, branch_args)) {
+                emitPhiCopies(current_block_label, true_label);
+                true_copies = false;
+            } else if (false_copies && canHoistPhiCopies(false_label, true_label, branch_args)) {
+                emitPhiCopies(current_block_label, false_label);
+                false_copies = false;
+            }
+            std::string next_label = nextBlockLabel();
+            if (!true_copies && !false_copies && true_label == next_label) {
+                emit(invertBranch(branch_op) + " " + branch_args + ", " + false_label);
+            } else if (!true_copies && false_label == next_label) {
+                emit(branch_op + " " + branch_args + ", " + true_label);
+                emitPhiCopies(current_block_label, false_label);
+            } else {
+                std::string stub_label = "phi_edge" + std::to_string(phi_edge_count++);
+                emit(branch_op + " " + branch_args + ", " + (true_copies ? stub_label : true_label));
+                emitPhiCopies(current_block_label, false_label);
+                emit("j " + false_label);
+                if (true_copies) {
+                    func_body << stub_label << ":\n";
+                    emitPhiCopies(current_block_label, true_label);
+                    emit("j " + true_label);
+                }
+            }
+            break;
+        }
+        default:
+            // phi 不生成代码：拷贝在各前驱块的跳转处完成 (emitPhiCopies)
+            break;
+    }
+}
+
+// * 常量乘法：把 |c| 写成规范有符号数字（CSD）形式，c = ±Σ ±2^k，
+// 每一项是一次移位，项之间一次加减，c < 0 时最后取负
+static std::vector<std::pair<int, int>> signedDigits(int c) {
+    std::vector<std::pair<int, int>> terms; // (移位量, ±1)
+    long long x = c < 0 ? -(long long)c : (long long)c;
+    for (int k = 0; x != 0; ++k, x >>= 1) {
+        if (x & 1) {
+            int digit = (x & 3) == 1 ? 1 : -1;
+            terms.push_back({k, digit});
+            x -= digit;
+        }
+    }
+    return terms;
+}
+
+// 移位加减序列的指令条数；MUL_COST 是 li + mul（乘法按多周期计）的代价
+int MipsGenerator::mulByConstantCost(int c) {
+    if (c == 0 || c == 1) return 1;
+    auto terms = signedDigits(c);
+    int cost = (int)terms.size() - 1; // 加减
+    for (const auto& term : terms) {
+        if (term.first > 0) cost++;   // 移位
+    }
+    if (c < 0) cost++;                // 取负
+    return cost;
+}
+
+void MipsGenerator::emitMulByConstant(const std::string& rd, const std::string& rs, int c) {
+    if (c == 0) {
+        emit("move " + rd + ", $zero");
+        return;
+    }
+    if (c == 1) {
+        if (rd != rs) emit("move " + rd + ", " + rs);
+        return;
+    }
+    auto terms = signedDigits(c);
+    // CSD 的最高位一定是 +1，从它开始累加，避免先取负；中间结果放在 $v1，最后一条写入 rd
+    std::reverse(terms.begin(), terms.end());
+    std::vector<std::string> code;
+    std::string acc = rs;
+    if (terms[0].first > 0) {
+        code.push_back("sll $v1, " + rs + ", " + std::to_string(terms[0].first));
+        acc = "$v1";
+    }
+    for (size_t i = 1; i < terms.size(); ++i) {
+        std::string term = rs;
+        if (terms[i].first > 0) {
+            code.push_back("sll $v0, " + rs + ", " + std::to_string(terms[i].first));
+            term = "$v0";
+        }
+        code.push_back(std::string(terms[i].second > 0 ? "addu" : "subu") + " $v1, " + acc + ", " + term);
+        acc = "$v1";
+    }
+    if (c < 0) {
+        code.push_back("negu $v1, " + acc);
+    }
+    std::string& last = code.back();
+    size_t first_space = last.find(' ');
+    last = last.substr(0, first_space + 1) + rd + last.substr(last.find(','));
+    for (const auto& asm_code : code) emit(asm_code);
+}
+
+// * 有符号除以常量 d 的魔数（Hacker's Delight 10-1）：n / d = (mulhs(n, magic) [+/- n]) >> shift，再加上符号位修正
+static void signedDivMagic(int d, int& magic, int& shift) {
+    const uint32_t two31 = 0x80000000u;
+    uint32_t ad = d < 0 ? 0u - (uint32_t)d : (uint32_t)d;
+    uint32_t t = two31 + ((uint32_t)d >> 31);
+    uint32_t anc = t - 1 - t % ad;
+    uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+    uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+    uint32_t delta;
+    int p = 31;
+    do {
+        p++;
+        q1 *= 2; r1 *= 2;
+        if (r1 >= anc) { q1++; r1 -= anc; }
+        q2 *= 2; r2 *= 2;
+        if (r2 >= ad) { q2++; r2 -= ad; }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    magic = (int)(q2 + 1);
+    if (d < 0) magic = -magic;
+    shift = p - 32;
+}
+
+// * 除数为常量的有符号除法/取余，结果写入 rd（rd 可能与 rs 相同，中间结果放在 $v0/$v1）
+// 2 的幂：加上偏置（负数时为 2^k - 1）后算术右移，向零取整；取余用掩码。
+// 其余常量：mult 魔数取高位，移位并加上商的符号位；取余为 n - (n / d) * d。
+// 返回 false 表示不处理（除数为 0 或 INT_MIN），仍使用 div
+bool MipsGenerator::emitDivByConstant(const std::string& rd, const std::string& rs, int d, bool want_rem) {
+    if (d == 0 || d == INT_MIN) return false;
+    if (d == 1 || d == -1) {
+        if (want_rem) emit("move " + rd + ", $zero");
+        else if (d == 1) emit("move " + rd + ", " + rs);
+        else emit("negu " + rd + ", " + rs);
+        return true;
+    }
+    uint32_t ad = d < 0 ? 0u - (uint32_t)d : (uint32_t)d;
+    if ((ad & (ad - 1)) == 0) {
+        int k = 0;
+        while ((1u << k) < ad) k++;
+        // bias = n < 0 ? 2^k - 1 : 0
+        if (k > 1) {
+            emit("sra $v1, " + rs + ", " + std::to_string(k - 1));
+            emit("srl $v1, $v1, " + std::to_string(32 - k));
+        } else {
+            emit("srl $v1, " + rs + ", 31");
+        }
+        if (want_rem) {
+            // n % 2^k = ((n + bias) & (2^k - 1)) - bias
+            emit("addu $v0, " + rs + ", $v1");
+            if (k <= 16) {
+                emit("andi $v0, $v0, " + std::to_string((1u << k) - 1));
+            } else {
+                emit("sll $v0, $v0, " + std::to_string(32 - k));
+                emit("srl $v0, $v0, " + std::to_string(32 - k));
+            }
+            emit("subu " + rd + ", $v0, $v1");
+        } else {
+            emit("addu $v1, " + rs + ", $v1");
+            emit("sra " + rd + ", $v1, " + std::to_string(k));
+            if (d < 0) emit("negu " + rd + ", " + rd);
+        }
+        return true;
+    }
+
+    int magic, shift;
+    signedDivMagic(d, magic, shift);
+    emit("li $v1, " + std::to_string(magic));
+    emit("mult " + rs + ", $v1");
+    emit("mfhi $v1");
+    if (d > 0 && magic < 0) emit("addu $v1, $v1, " + rs);
+    if (d < 0 && magic > 0) emit("subu $v1, $v1, " + rs);
+    if (shift > 0) emit("sra $v1, $v1, " + std::to_string(shift));
+    emit("srl $v0, $v1, 31");
+    if (!want_rem) {
+        emit("addu " + rd + ", $v1, $v0");
+        return true;
+    }
+    emit("addu $v1, $v1, $v0");
+    emit("li $v0, " + std::to_string(d));
+    emit("mul $v0, $v1, $v0");
+    emit("subu " + rd + ", " + rs + ", $v0");
+    return true;
+}
+
+// 当前指令之后紧邻的基本块标签（用于判断跳转目标能否直接落入），没有则返回空串
+std::string MipsGenerator::nextBlockLabel() {
+    const auto& lines = *current_func_lines;
+    size_t next = current_instr_index + 1;
+    if (next < lines.size() && lines[next].inst == nullptr) return lines[next].label;
+    return "";
+}
+
+// * 条件分支跳回循环头（目标块在当前块之前）时，这条边上的 phi 拷贝能否提前到分支之前执行：
+// 拷贝只涉及寄存器与立即数（不会用到 $t8/$v1 与栈），目标寄存器不是分支操作数，
+// 也不保存另一条出边仍要使用的值
+bool MipsGenerator::canHoistPhiCopies(const std::string& to, const std::string& other,
+                                      const std::string& branch_args) {
+    const auto& lines = *current_func_lines;
+    bool backward = false;
+    for (int i = 0; i < current_instr_index && !backward; ++i) {
+        backward = lines[i].inst == nullptr && lines[i].label == to;
+    }
+    if (!backward) return false;
+
+    std::set<std::string> dests, dest_regs, sources;
+    for (const auto& copy : phi_copies[{current_block_label, to}]) {
+        if (!reg_assign.count(copy.first)) return false;
+        if (!isNumber(copy.second) && !reg_assign.count(copy.second)) return false;
+        dests.insert(copy.first);
+        dest_regs.insert(getRegName(reg_assign[copy.first]));
+        sources.insert(copy.second);
+    }
+    std::string args = branch_args;
+    std::replace(args.begin(), args.end(), ',', ' ');
+    std::stringstream ss(args);
+    std::string reg;
+    while (ss >> reg) {
+        if (dest_regs.count(reg) || reg == "$t9") return false; // $t9 是拷贝成环时的临时寄存器
+    }
+    auto other_copies = phi_copies.find({current_block_label, other});
+    if (other_copies != phi_copies.end()) {
+        for (const auto& copy : other_copies->second) {
+            auto it = reg_assign.find(copy.second);
+            if (dests.count(copy.second) || (it != reg_assign.end() && dest_regs.count(getRegName(it->second)))) {
+                return false;
+            }
+        }
+    }
+    // 只作拷贝来源的值在分支处结束活跃，可以与目标共用寄存器；其余分支后仍活跃的值不能被覆盖
+    for (const auto& v : live_after[current_instr_index]) {
+        if (dests.count(v)) return false;
+        if (sources.count(v)) continue;
+        auto it = reg_assign.find(v);
+        if (it != reg_assign.end() && dest_regs.count(getRegName(it->second))) return false;
+    }
+    return true;
+}
+
+// * 识别 icmp -> br 与 icmp -> zext -> icmp ne/eq 0 -> br 两种单次使用的条件链，
+// 链上的中间指令全部跳过，由 br 按融合后的谓词生成比较跳转
+bool MipsGenerator::fuseCompareBranch(const std::string& dest, const std::string& pred,
+                                      const std::string& s1, const std::string& s2) {
+    const auto& lines = *current_func_lines;
+    auto at = [&](size_t i, IROpcode opcode) -> const IRInst* {
+        if (i >= lines.size() || lines[i].inst == nullptr || lines[i].inst->opcode != opcode) return nullptr;
+        return lines[i].inst;
+    };
+    if (var_use_count[dest] != 1) return false;
+    std::string value = dest, cond = pred;
+    size_t j = current_instr_index + 1;
+    // %z = zext i1 %c to i32 ; %d = icmp ne i32 %z, 0
+    const IRInst* zext = at(j, IROpcode::Zext);
+    if (zext && zext->operands[0] == value && var_use_count[zext->dest] == 1) {
+        const IRInst* test = at(j + 1, IROpcode::ICmp);
+        if (test && (test->predicate == "ne" || test->predicate == "eq") &&
+            test->operands[0] == zext->dest && test->operands[1] == "0" && var_use_count[test->dest] == 1) {
+            if (test->predicate == "eq") {
+                static const std::map<std::string, std::string> inverse = {
+                    {"eq", "ne"}, {"ne", "eq"}, {"slt", "sge"}, {"sge", "slt"}, {"sgt", "sle"}, {"sle", "sgt"},
+                    {"ult", "uge"}, {"uge", "ult"}, {"ugt", "ule"}, {"ule", "ugt"}};
+                cond = inverse.at(cond);
+            }
+            value = test->dest;
+            j += 2;
+        }
+    }
+    const IRInst* br = at(j, IROpcode::CondBr);
+    if (!br || br->operands[0] != value) return false;
+    for (size_t k = current_instr_index + 1; k < j; ++k) skipped_instrs.insert((int)k);
+    fused_conditions[value] = {cond, s1, s2};
+    return true;
+}
+
+// * 为“a pred b 成立则跳转”选择分支指令：与 0 比较用 beq/bne/bltz/blez/bgtz/bgez，
+// 相等比较用 beq/bne，其余先用 slt/slti 把结果算到 $v1（compare）再 bne/beq
+void MipsGenerator::lowerCompareBranch(std::string pred, std::string s1, std::string s2,
+                                       std::string& branch_op, std::string& branch_args, std::string& compare) {
+    static const std::map<std::string, std::string> mirror = {
+        {"eq", "eq"}, {"ne", "ne"}, {"slt", "sgt"}, {"sgt", "slt"}, {"sle", "sge"}, {"sge", "sle"}};
+    bool is_unsigned = pred[0] == 'u'; // 无符号比较（指针）：与 0 比较不能用 bltz 等，slt 换成 sltu
+    if (is_unsigned) pred[0] = 's';
+    if (isNumber(s1) && !isNumber(s2)) {
+        std::swap(s1, s2);
+        pred = mirror.at(pred);
+    }
+    compare.clear();
+    if (isNumber(s2) && std::stoi(s2) == 0 && (!is_unsigned || pred == "eq" || pred == "ne")) {
+        static const std::map<std::string, std::string> zero_branch = {
+            {"eq", "beq"}, {"ne", "bne"}, {"slt", "bltz"}, {"sle", "blez"}, {"sgt", "bgtz"}, {"sge", "bgez"}};
+        std::string r1 = getRegName(getReg(s1, false));
+        branch_op = zero_branch.at(pred);
+        branch_args = (pred == "eq" || pred == "ne") ? r1 + ", $zero" : r1;
+        return;
+    }
+    if (pred == "eq" || pred == "ne") {
+        int r1 = getReg(s1, false);
+        int r2 = getReg(s2, false);
+        branch_op = pred == "eq" ? "beq" : "bne";
+        branch_args = getRegName(r1) + ", " + getRegName(r2);
+        return;
+    }
+    // a < b / a >= b 直接比较；a > b / a <= b 交换操作数，或与立即数 b + 1 比较
+    bool swap_operands = (pred == "sgt" || pred == "sle");
+    branch_op = (pred == "slt" || pred == "sgt") ? "bne" : "beq";
+    branch_args = "$v1, $zero";
+    std::string r1 = getRegName(getReg(s1, false));
+    if (isNumber(s2)) {
+        long long imm = std::stoll(s2) + (swap_operands ? 1 : 0);
+        if (isSmallImmediate((int)imm) && imm == (int)imm) {
+            compare = std::string(is_unsigned ? "sltiu" : "slti") + " $v1, " + r1 + ", " + std::to_string(imm);
+            if (swap_operands) branch_op = branch_op == "bne" ? "beq" : "bne";
+            return;
+        }
+    }
+    std::string r2 = getRegName(getReg(s2, false));
+    std::string lt = is_unsigned ? "sltu $v1, " : "slt $v1, ";
+    compare = swap_operands ? lt + r2 + ", " + r1 : lt + r1 + ", " + r2;
+}
+
+std::string MipsGenerator::invertBranch(const std::string& branch_op) {
+    static const std::map<std::string, std::string> inverse = {
+        {"beq", "bne"}, {"bne", "beq"}, {"bltz", "bgez"}, {"bgez", "bltz"}, {"blez", "bgtz"}, {"bgtz", "blez"}};
+    return inverse.at(branch_op);
+}
+
+// 函数调用：内置 IO 函数直接 syscall，用户函数按调用约定传参并 jal
+void MipsGenerator::processCall(const IRInst& inst) {
+    const std::string& dest = inst.dest;
+    const std::string& ret_type = inst.type;
+    const std::string& real_name = inst.callee;
+    const std::vector<std::string>& arg_values = inst.operands;
+
+    // * 内置函数走 syscall，只会改写 $v0/$a0，寄存器无需写回或保存
+    if (isBuiltinFunction(real_name)) {
+        int syscall_code = 5;
+        if (real_name == "putint") syscall_code = 1;
+        else if (real_name == "putstr") syscall_code = 4;
+        else if (real_name == "putch") syscall_code = 11;
+        if (!arg_values.empty()) {
+            if (isNumber(arg_values[0])) {
+                emit("li $a0, " + arg_values[0]);
+            } else {
+                emit("move $a0, " + getRegName(getReg(arg_values[0], false)));
+            }
+        }
+        emit("li $v0, " + std::to_string(syscall_code));
+        emit("syscall");
+        if (syscall_code == 5 && !dest.empty()) {
+            // 结果在 $v0，存入 dest
+            int rd = getReg(dest, true);
+            emit("move " + getRegName(rd) + ", $v0");
+        }
+        return;
+    }
+
+    // * 尾调用：调用后紧跟 ret 其结果（或 ret void），参数不超过 4 个且本函数没有栈上的局部数组时，
+    // 先拆除本函数的栈帧再 j 到被调函数，被调函数直接返回到本函数的调用者
+    const auto& lines = *current_func_lines;
+    bool tail_call = current_function_name != "main" && arg_values.size() <= 4 &&
+                     current_instr_index + 1 < (int)lines.size() &&
+                     std::none_of(lines.begin(), lines.end(), [](const FuncLine& l) {
+                         return l.inst && l.inst->opcode == IROpcode::Alloca;
+                     });
+    if (tail_call) {
+        const IRInst* ret = lines[current_instr_index + 1].inst;
+        tail_call = ret && ret->opcode == IROpcode::Ret &&
+                    (dest.empty() ? ret->operands.empty() : !ret->operands.empty() && ret->operands[0] == dest);
+    }
+
+    // * 调用后仍活跃且位于 $t 寄存器中的变量，需要在调用前后保存/恢复（$s 由被调用者保存）
+    std::vector<std::string> saved_vars;
+    for (const auto& var : call_live_across[current_instr_index]) {
+        if (reg_assign.count(var) && reg_assign[var] < ALLOC_REG_END) {
+            emitStoreWord(getRegName(reg_assign[var]), getStackOffset(var), "$fp");
+            emit("# Save " + var);
+            saved_vars.push_back(var);
+        }
+    }
+
+    // * 第 5 个起的参数写入出参区 4*i($sp)
+    for (int i = 4; i < (int)arg_values.size(); ++i) {
+        int r = getReg(arg_values[i], false);
+        emitStoreWord(getRegName(r), 4 * i, "$sp");
+    }
+    // * 前 4 个参数直接送入 $a0-$a3：$a 寄存器不作为任何值的存放位置，
+    // 并行拷贝的目标与来源不会相交，按顺序发射即可
+    for (int i = 0; i < (int)arg_values.size() && i < 4; ++i) {
+        std::string arg_reg = "$a" + std::to_string(i);
+        if (isNumber(arg_values[i])) {
+            emit(std::stoi(arg_values[i]) == 0 ? "move " + arg_reg + ", $zero" : "li " + arg_reg + ", " + arg_values[i]);
+        } else {
+            emit("move " + arg_reg + ", " + getRegName(getReg(arg_values[i], false)));
+        }
+    }
+    if (tail_call) {
+        emitEpilogue();
+        emit("j " + real_name);
+        skipped_instrs.insert(current_instr_index + 1);
+        return;
+    }
+    flushRegisters(); // 被调函数会改写 $t8/$t9，缓存中的脏值先写回
+
+    emit("jal " + real_name);
+    if (ret_type != "void" && !dest.empty()) {
+        int rd = getReg(dest, true);
+        emit("move " + getRegName(rd) + ", $v0");
+    }
+    for (const auto& var : saved_vars) {
+        emitLoadWord(getRegName(reg_assign[var]), getStackOffset(var), "$fp");
+        emit("# Restore " + var);
+    }
+}
+
+// 恢复 $s 寄存器并拆除栈帧（之后由调用方生成 jr $ra 或尾调用的 j）
+void MipsGenerator::emitEpilogue() {
+    // 栈帧即将销毁，缓存寄存器直接清空
+    for (int i = ALLOC_REG_END; i < 10; ++i) {
+        regs[i].busy = false;
+        regs[i].dirty = false;
+        regs[i].name = "";
+    }
+    var_in_reg.clear();
+
+    for (const auto& slot : saved_reg_slots) {
+        emitLoadWord(getRegName(slot.first), slot.second, "$fp");
+    }
+    if (omit_frame_pointer) {
+        if (frame_bias > 0) emit("addiu $sp, $sp, " + std::to_string(frame_bias));
+        return;
+    }
+    // 栈布局: $fp 指向旧栈顶，$ra 在 $fp-8，$fp 在 $fp-4
+    emit("subu $sp, $fp, 8");   // 恢复 $sp 到保存区
+    emit("lw $ra, 0($sp)");     // 恢复 $ra
+    emit("lw $fp, 4($sp)");     // 恢复 $fp
+    emit("addiu $sp, $sp, 8");  // 释放保存区
+}
+
+// * 在 from -> to 的边上把 phi 展开为并行拷贝（调用前缓存寄存器已写回）
+// 目标/来源可能是全局分配的寄存器或栈槽；先发射目标不再被读取的拷贝，
+// 剩下的都在环上，用 $t9 暂存一个目标的旧值打破环。$t8 用于内存到内存的中转
+void MipsGenerator::emitPhiCopies(const std::string& from, const std::string& to) {
+    auto it = phi_copies.find({from, to});
+    if (it == phi_copies.end()) return;
+
+    struct Loc {
+        std::string reg; // 寄存器名；为空表示栈槽
+        int offset;      // 栈槽偏移
+        std::string imm; // 立即数来源
+        bool operator==(const Loc& o) const {
+            if (!imm.empty() || !o.imm.empty()) return false;
+            return reg.empty() ? (o.reg.empty() && offset == o.offset) : reg == o.reg;
+        }
+    };
+    auto locate = [&](const std::string& v) {
+        Loc loc{"", 0, ""};
+        if (isNumber(v)) loc.imm = v;
+        else if (reg_assign.count(v)) loc.reg = getRegName(reg_assign[v]);
+        else loc.offset = getStackOffset(v);
+        return loc;
+    };
+    auto move = [&](const Loc& dst, const Loc& src) {
+        std::string src_reg = src.reg;
+        std::string tmp = dst.reg.empty() ? "$t8" : dst.reg;
+        if (!src.imm.empty()) {
+            emit(src.imm == "0" ? "move " + tmp + ", $zero" : "li " + tmp + ", " + src.imm);
+            src_reg = tmp;
+        } else if (src.reg.empty()) {
+            emitLoadWord(tmp, src.offset, "$fp");
+            src_reg = tmp;
+        }
+        if (dst.reg.empty()) emitStoreWord(src_reg, dst.offset, "$fp");
+        else if (src_reg != dst.reg) emit("move " + dst.reg + ", " + src_reg);
+    };
+
+    std::vector<std::pair<Loc, Loc>> pending;
+    for (const auto& copy : it->second) {
+        Loc dst = locate(copy.first), src = locate(copy.second);
+        if (!(dst == src)) pending.push_back({dst, src});
+    }
+    while (!pending.empty()) {
+        bool progress = false;
+        for (size_t k = 0; k < pending.size(); ++k) {
+            bool blocked = false;
+            for (size_t j = 0; j < pending.size(); ++j) {
+                if (j != k && pending[j].second == pending[k].first) {
+                    blocked = true;
+                    break;
+                }
+            }
+            if (blocked) continue;
+            move(pending[k].first, pending[k].second);
+            pending.erase(pending.begin() + k);
+            progress = true;
+            break;
+        }
+        if (progress) continue;
+        // 全部在环上：把第一个目标的旧值移到 $t9，读它的拷贝改为读 $t9
+        Loc saved = pending[0].first;
+        Loc temp{"$t9", 0, ""};
+        move(temp, saved);
+        for (auto& copy : pending) {
+            if (copy.second == saved) copy.second = temp;
+        }
+    }
+}
@@ -1,70 +1,127 @@
-// MipsGenerator.h
-#ifndef COMPILER_MIPSGENERATOR_H
-#define COMPILER_MIPSGENERATOR_H
-
-#include <string>
-#include <vector>
-#include <map>
-#include <fstream>
-#include <sstream>
-#include <list>
-
-struct RegInfo {
-    std::string name; // 当前存放的变量名 (例如 "%1", "%a_addr")
-    bool busy;        // 是否被占用
-    bool dirty;       // 是否被修改过 (与内存不一致)
-    int last_use;     // 最后一次使用的时间戳 (用于 LRU 置换)
-};
-
-class MipsGenerator {
-private:
-    std::ifstream llvm_file;
-    std::ofstream mips_file;
-
-    // 栈管理
-    std::map<std::string, int> stack_map;
-    std::map<std::string, bool> is_alloca_var; // 标记哪些变量是 alloca 出来的（值是地址）
-    int current_stack_offset;
-
-    // 寄存器管理 ($t0 - $t9, 对应索引 0 - 9)
-    RegInfo regs[10];
-    std::map<std::string, int> var_in_reg; // 变量 -> 寄存器索引
-    int time_counter; // 模拟时间，用于 LRU
-
-    // 辅助函数
-    void parseGlobalVars();
-    void parseFunctions();
-    void processInstruction(const std::string& line);
-
-    // 栈操作
-    void allocStack(const std::string& var_name, int size = 4);
-    int getStackOffset(const std::string& var_name);
-
-    // 寄存器分配核心逻辑
-    int getReg(const std::string& var_name, bool is_def = false, bool is_addr = false);
-    int findFreeReg();
-    int spillReg(); // 溢出最久未使用的寄存器
-    void flushRegisters(); // 清空所有寄存器（写回脏数据）
-    std::string getRegName(int index);
-
-    // 工具
-    bool isNumber(const std::string& s);
-    void emit(const std::string& asm_code);
-
-    // * 优化相关
-    std::map<std::string, int> var_use_count; // 变量使用次数统计
-    void preAnalyzeFunction(const std::vector<std::string>& instructions);
-    bool isSmallImmediate(int val); // 检查是否可以用立即数指令
-
-    // 大偏移处理辅助函数
-    void emitLoadWord(const std::string& dest_reg, int offset, const std::string& base_reg);
-    void emitStoreWord(const std::string& src_reg, int offset, const std::string& base_reg);
-    void emitLoadAddress(const std::string& dest_reg, int offset, const std::string& base_reg);
-
-public:
-    MipsGenerator(const std::string& llvm_path, const std::string& mips_path);
-    ~MipsGenerator();
-    void generate();
-};
-
+// MipsGenerator.h
+#ifndef COMPILER_MIPSGENERATOR_H
+#define COMPILER_MIPSGENERATOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <list>
+#include <set>
+#include "IRModule.h"
+
+struct RegInfo {
+    std::string name; // 当前存放的变量名 (例如 "%1", "%a_addr")
+    bool busy;        // 是否被占用
+    bool dirty;       // 是否被修改过 (与内存不一致)
+    int last_use;     // 最后一次使用的时间戳 (用于 LRU 置换)
+};
+
+class MipsGenerator {
+private:
+    const IRModule& module; // 中端优化后的内存 IR，直接翻译，不再经过 llvm_ir.txt
+    std::ofstream mips_file;
+    std::stringstream func_body; // 当前函数的指令缓冲（序言在函数体翻译完成后生成）
+
+    // 栈管理
+    std::map<std::string, int> stack_map;
+    std::map<std::string, bool> is_alloca_var; // 标记哪些变量是 alloca 出来的（值是地址）
+    int current_stack_offset;
+    bool omit_frame_pointer; // * 叶函数省略帧指针：$fp 相对偏移改为 $sp + frame_bias 寻址
+    int frame_bias;          // 叶函数的栈帧大小
+
+    // 寄存器管理 ($t0 - $t9, 对应索引 0 - 9)
+    // * $t0-$t7 由全局分配器按函数分配；$t8/$t9 作为溢出变量与立即数的 LRU 缓存
+    // * $s0-$s7 (索引 10 - 17) 只由全局分配器使用，不进入 LRU 缓存
+    RegInfo regs[10];
+    std::map<std::string, int> var_in_reg; // 变量 -> 寄存器索引（仅 LRU 缓存部分）
+    int time_counter; // 模拟时间，用于 LRU
+
+    // * 全局寄存器分配（线性扫描）
+    struct LiveInterval {
+        std::string name;
+        int start;   // 起点（指令序号 * 2，定义点为 * 2 + 1）
+        int end;     // 终点
+        double cost; // 溢出代价（按循环深度加权的使用次数）
+        int reg;     // 分配到的寄存器索引，-1 表示溢出
+    };
+    std::map<std::string, int> reg_assign; // 变量 -> 全局分配的寄存器索引
+    std::map<int, std::vector<std::string>> call_live_across; // call 指令序号 -> 调用后仍活跃的变量
+    std::set<int> used_saved_regs; // 本函数分配到的 $s 寄存器
+    std::vector<std::pair<int, int>> saved_reg_slots; // 序言中保存的 $s 寄存器 -> 栈槽偏移
+    int current_instr_index; // 当前正在翻译的指令序号
+    std::vector<std::set<std::string>> live_after; // 每条指令之后仍活跃的值
+
+    // * SSA 消解：phi 在前驱块末尾展开为并行拷贝
+    std::map<std::pair<std::string, std::string>,
+             std::vector<std::pair<std::string, std::string>>> phi_copies; // (前驱, 后继) -> [(phi 结果, 入边值)]
+    std::string current_block_label; // 当前正在翻译的基本块
+    int phi_edge_count;              // 条件跳转边上拷贝块的编号
+
+    // 函数体按顺序展开为标签行与指令行，下标即指令序号
+    struct FuncLine {
+        std::string label;   // 非空表示基本块入口
+        const IRInst* inst;  // 指令；标签行为 nullptr
+    };
+
+    // 辅助函数
+    void parseGlobalVars();
+    void parseFunctions();
+    void processInstruction(const FuncLine& line);
+    void processCall(const IRInst& inst);
+    void emitPhiCopies(const std::string& from, const std::string& to);
+    void emitEpilogue();
+
+    // * 比较与跳转融合
+    const std::vector<FuncLine>* current_func_lines; // 当前函数的指令
+    std::set<int> skipped_instrs; // 已并入后续 br 的指令序号
+    std::map<std::string, std::vector<std::string>> fused_conditions; // br 条件 -> {谓词, 操作数1, 操作数2}
+    std::string nextBlockLabel();
+    bool fuseCompareBranch(const std::string& dest, const std::string& pred,
+                           const std::string& s1, const std::string& s2);
+    void lowerCompareBranch(std::string pred, std::string s1, std::string s2,
+                            std::string& branch_op, std::string& branch_args, std::string& compare);
+    std::string invertBranch(const std::string& branch_op);
+    bool canHoistPhiCopies(const std::string& to, const std::string& other, const std::string& branch_args);
+    void allocateRegisters(const std::vector<FuncLine>& instructions,
+                           const std::vector<std::string>& arg_names);
+
+    // 栈操作
+    void allocStack(const std::string& var_name, int size = 4);
+    int getStackOffset(const std::string& var_name);
+
+    // 寄存器分配核心逻辑
+    int getReg(const std::string& var_name, bool is_def = false, bool is_addr = false);
+    int findFreeReg();
+    int spillReg(); // 溢出最久未使用的寄存器
+    void flushRegisters(); // 清空所有寄存器（写回仍活跃的脏数据）
+    void releaseDeadRegisters(); // 释放当前指令之后不再活跃的缓存值
+    bool isLiveAfterCurrent(const std::string& var);
+    std::string getRegName(int index);
+
+    // 工具
+    bool isNumber(const std::string& s);
+    void emit(const std::string& asm_code);
+
+    // * 优化相关
+    std::map<std::string, int> var_use_count; // 变量使用次数统计
+    void preAnalyzeFunction(const std::vector<FuncLine>& instructions);
+    bool isSmallImmediate(int val); // 检查是否可以用立即数指令
+    bool emitDivByConstant(const std::string& rd, const std::string& rs, int d, bool want_rem);
+    static const int MUL_COST = 4; // li + mul 的代价，移位加减序列不超过它时才替换
+    int mulByConstantCost(int c);
+    void emitMulByConstant(const std::string& rd, const std::string& rs, int c);
+
+    // 大偏移处理辅助函数
+    void emitLoadWord(const std::string& dest_reg, int offset, const std::string& base_reg);
+    void emitStoreWord(const std::string& src_reg, int offset, const std::string& base_reg);
+    void emitLoadAddress(const std::string& dest_reg, int offset, const std::string& base_reg);
+
+public:
+    MipsGenerator(const IRModule& ir_module, const std::string& mips_path);
+    ~MipsGenerator();
+    void generate();
+};
+
 #endif //COMPILER_MIPSGENERATOR_H
\ No newline at end of file
@@ -9,29 +9,148 @@
 #include <sstream>
 #include <algorithm>
 #include <map>
+#include <unordered_map>
+#include <deque>
 #include <stack>
+#include <string_view>
+#include <cstdint>
+#include <charconv>
+
+
+// --- 单词类别 ---
+// 枚举名与 lexer.txt / parser.txt 中的类别码一致，只在输出文件时转换为文本
+enum class TokenKind : uint8_t {
+    IDENFR, INTCON, STRCON,
+    CONSTTK, INTTK, STATICTK, BREAKTK, CONTINUETK, IFTK, MAINTK, ELSETK, FORTK, RETURNTK, VOIDTK, PRINTFTK,
+    NOT, AND, OR, PLUS, MINU, MULT, DIV, MOD,
+    LSS, LEQ, GRE, GEQ, EQL, NEQ, ASSIGN,
+    SEMICN, COMMA, LPARENT, RPARENT, LBRACK, RBRACK, LBRACE, RBRACE,
+    END // 输入结束（输出为 EOF）
+};
 
+const char* token_kind_name(TokenKind kind) {
+    static const char* names[] = {
+            "IDENFR", "INTCON", "STRCON",
+            "CONSTTK", "INTTK", "STATICTK", "BREAKTK", "CONTINUETK", "IFTK", "MAINTK", "ELSETK", "FORTK",
+            "RETURNTK", "VOIDTK", "PRINTFTK",
+            "NOT", "AND", "OR", "PLUS", "MINU", "MULT", "DIV", "MOD",
+            "LSS", "LEQ", "GRE", "GEQ", "EQL", "NEQ", "ASSIGN",
+            "SEMICN", "COMMA", "LPARENT", "RPARENT", "LBRACK", "RBRACK", "LBRACE", "RBRACE",
+            "EOF"
+    };
+    return names[static_cast<int>(kind)];
+}
 
 // --- 宏定义和全局常量 ---
 const char* keywords[] = {
         "const","int","static","break","continue",
         "if","main","else","for","return","void","printf"
 };
-const char* keymap[] = {
-        "CONSTTK","INTTK","STATICTK","BREAKTK",
-        "CONTINUETK","IFTK","MAINTK","ELSETK","FORTK","RETURNTK","VOIDTK","PRINTFTK"
+const TokenKind keymap[] = {
+        TokenKind::CONSTTK, TokenKind::INTTK, TokenKind::STATICTK, TokenKind::BREAKTK,
+        TokenKind::CONTINUETK, TokenKind::IFTK, TokenKind::MAINTK, TokenKind::ELSETK, TokenKind::FORTK,
+        TokenKind::RETURNTK, TokenKind::VOIDTK, TokenKind::PRINTFTK
 };
 #define KEYWORD_COUNT (sizeof(keywords) / sizeof(keywords[0]))
-#define MAX_TOKEN_LEN 10000
 
 
 // --- 全局数据和结构体 ---
+// * 单词序列按列存放（SoA）：text 是整个源文本，每个单词只记录类别、词素偏移、长度与行号
+struct TokenList {
+    std::string text;
+    std::vector<TokenKind> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<int> lines;
+
+    size_t size() const { return kinds.size(); }
+    std::string_view lexeme(size_t i) const { return std::string_view(text).substr(offsets[i], lengths[i]); }
+    void clear() {
+        text.clear();
+        kinds.clear();
+        offsets.clear();
+        lengths.clear();
+        lines.clear();
+    }
+};
+
+// 解析器读取的单个单词：按值返回的轻量视图，value 指向源文本 TokenList::text
 struct Token {
-    std::string type;
-    std::string value;
+    TokenKind kind;
+    std::string_view value;
     int line;
 };
 
+// --- 产物输出 ---
+// * 各中间产物可单独开关，默认只生成 mips.txt；关闭的产物在解析过程中不做任何格式化与记录
+struct ArtifactOptions {
+    bool preprocessed = false; // preprocessing.txt
+    bool lexer = false;        // lexer.txt
+    bool parser = false;       // parser.txt
+    bool symbol = false;       // symbol.txt
+    bool error = false;        // error.txt
+    bool llvm = false;         // llvm_ir.txt
+
+    // 按名称打开一项产物，"all" 打开全部；名称未知时返回 false
+    bool enable(std::string_view name) {
+        if (name == "all") {
+            preprocessed = lexer = parser = symbol = error = llvm = true;
+        } else if (name == "preprocessed") preprocessed = true;
+        else if (name == "lexer") lexer = true;
+        else if (name == "parser") parser = true;
+        else if (name == "symbol") symbol = true;
+        else if (name == "error") error = true;
+        else if (name == "llvm") llvm = true;
+        else return false;
+        return true;
+    }
+};
+ArtifactOptions g_artifacts;
+
+// * 产物文件的缓冲写出：内容先拼接在内存中，超过 FLUSH_SIZE 或关闭时整块 fwrite
+class ArtifactWriter {
+public:
+    ArtifactWriter() = default;
+    ArtifactWriter(const ArtifactWriter&) = delete;
+    ArtifactWriter& operator=(const ArtifactWriter&) = delete;
+    ~ArtifactWriter() { close(); }
+
+    bool open(const char* path) {
+        close();
+        file = fopen(path, "w");
+        return file != nullptr;
+    }
+    bool is_open() const { return file != nullptr; }
+
+    void write(std::string_view text) {
+        buffer.append(text.data(), text.size());
+        if (buffer.size() >= FLUSH_SIZE) flush();
+    }
+    void write(char ch) { buffer.push_back(ch); }
+    void write(int value) {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr - digits);
+    }
+
+    void close() {
+        if (file == nullptr) return;
+        flush();
+        fclose(file);
+        file = nullptr;
+    }
+
+private:
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+    FILE* file = nullptr;
+    std::string buffer;
+
+    void flush() {
+        fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+};
+
 struct FileErrorRecord {
     int line;
     char type;
@@ -75,67 +194,121 @@ struct FuncRParamsResult {
     std::vector<std::string> semantic_types; // 用于 D/E 错误检查
 };
 std::vector<SymbolOutputRecord> g_symbol_output_records;
-FILE* g_symbol_file = nullptr;
-std::vector<Token> g_tokens;
+TokenList g_tokens;
 using SymbolTable = std::map<std::string, Symbol>;
-std::vector<SymbolTable> g_scope_stack; // 作用域栈
-std::stack<int> g_active_scope_ids;
 
-FILE* g_error_file = nullptr;
-#define ERROR_b(line) do { if (g_error_file) fprintf(g_error_file, "%d b\n", line); } while(0)
-#define ERROR_c(line) do { if (g_error_file) fprintf(g_error_file, "%d c\n", line); } while(0)
-#define ERROR_d(line) do { if (g_error_file) fprintf(g_error_file, "%d d\n", line); } while(0)
-#define ERROR_e(line) do { if (g_error_file) fprintf(g_error_file, "%d e\n", line); } while(0)
-#define ERROR_f(line) do { if (g_error_file) fprintf(g_error_file, "%d f\n", line); } while(0)
-#define ERROR_g(line) do { if (g_error_file) fprintf(g_error_file, "%d g\n", line); } while(0)
-#define ERROR_h(line) do { if (g_error_file) fprintf(g_error_file, "%d h\n", line); } while(0)
-#define ERROR_i(line) do { if (g_error_file) fprintf(g_error_file, "%d i\n", line); } while(0)
-#define ERROR_j(line) do { if (g_error_file) fprintf(g_error_file, "%d j\n", line); } while(0)
-#define ERROR_k(line) do { if (g_error_file) fprintf(g_error_file, "%d k\n", line); } while(0)
-#define ERROR_l(line) do { if (g_error_file) fprintf(g_error_file, "%d l\n", line); } while(0)
-#define ERROR_m(line) do { if (g_error_file) fprintf(g_error_file, "%d m\n", line); } while(0)
-void sort_error_file(const char* error_path) {
-    std::vector<FileErrorRecord> records;
-    std::ifstream infile(error_path);
+// * 作用域符号表：标识符驻留为整数编号，每个编号对应一个绑定栈（栈顶为最内层可见的定义）
+// 查找只需一次哈希并返回指针，退出作用域时只弹出该作用域内定义的 k 个绑定
+class ScopedSymbolTable {
+public:
+    void enter_scope() { scope_names.emplace_back(); }
 
-    if (!infile.is_open()) {
-        // 如果文件不存在或无法打开（例如，如果根本没有错误输出），则跳过
-        return;
+    void exit_scope() {
+        std::vector<int>& names = scope_names.back();
+        for (auto it = names.rbegin(); it != names.rend(); ++it) {
+            bindings[*it].pop_back();
+            symbols.pop_back(); // 内层作用域的符号总是最后加入的
+        }
+        scope_names.pop_back();
     }
 
-    std::string line;
-    while (std::getline(infile, line)) {
-        if (line.empty()) continue;
+    bool empty() const { return scope_names.empty(); }
 
-        std::stringstream ss(line);
-        int line_num;
-        char error_type;
+    // 由内向外查找，未定义时返回 nullptr；指针在所属作用域退出前保持有效
+    Symbol* find(const std::string& name) {
+        const std::vector<Binding>* stack = binding_stack(name);
+        return stack && !stack->empty() ? stack->back().symbol : nullptr;
+    }
 
-        // 尝试解析：格式应为 "行号 错误类型"
-        if (ss >> line_num >> error_type) {
-            records.push_back({line_num, error_type});
-        }
+    // 只在当前作用域中查找 (重定义检查)
+    Symbol* find_local(const std::string& name) {
+        const std::vector<Binding>* stack = binding_stack(name);
+        if (!stack || stack->empty() || stack->back().depth != depth()) return nullptr;
+        return stack->back().symbol;
+    }
+
+    // 只在全局作用域中查找
+    Symbol* find_global(const std::string& name) {
+        const std::vector<Binding>* stack = binding_stack(name);
+        if (!stack || stack->empty() || stack->front().depth != 0) return nullptr;
+        return stack->front().symbol;
+    }
+
+    // 在当前作用域中定义符号（调用者负责重定义检查）
+    Symbol& insert(const std::string& name, const Symbol& symbol) {
+        int id = intern(name);
+        symbols.push_back(symbol);
+        bindings[id].push_back({depth(), &symbols.back()});
+        scope_names.back().push_back(id);
+        return symbols.back();
+    }
+
+private:
+    struct Binding {
+        int depth;      // 所在作用域的嵌套深度（0 为全局）
+        Symbol* symbol;
+    };
+    std::unordered_map<std::string, int> name_ids;  // 标识符 -> 驻留编号
+    std::vector<std::vector<Binding>> bindings;     // 编号 -> 绑定栈
+    std::vector<std::vector<int>> scope_names;      // 每个作用域中定义的标识符编号
+    std::deque<Symbol> symbols;                     // 符号存储，尾部增删不会使已有指针失效
+
+    int depth() const { return static_cast<int>(scope_names.size()) - 1; }
+
+    int intern(const std::string& name) {
+        auto result = name_ids.emplace(name, static_cast<int>(bindings.size()));
+        if (result.second) bindings.emplace_back();
+        return result.first->second;
+    }
+
+    const std::vector<Binding>* binding_stack(const std::string& name) const {
+        auto it = name_ids.find(name);
+        return it == name_ids.end() ? nullptr : &bindings[it->second];
+    }
+};
+ScopedSymbolTable g_symbols; // 作用域符号表
+std::stack<int> g_active_scope_ids;
+
+// * 错误先记录在内存中，最后按行号排序一次性写出；未开启 error.txt 时不记录
+std::vector<FileErrorRecord> g_error_records;
+inline void report_error(int line, char type) {
+    if (g_artifacts.error) g_error_records.push_back({line, type});
+}
+#define ERROR_a(line) report_error(line, 'a')
+#define ERROR_b(line) report_error(line, 'b')
+#define ERROR_c(line) report_error(line, 'c')
+#define ERROR_d(line) report_error(line, 'd')
+#define ERROR_e(line) report_error(line, 'e')
+#define ERROR_f(line) report_error(line, 'f')
+#define ERROR_g(line) report_error(line, 'g')
+#define ERROR_h(line) report_error(line, 'h')
+#define ERROR_i(line) report_error(line, 'i')
+#define ERROR_j(line) report_error(line, 'j')
+#define ERROR_k(line) report_error(line, 'k')
+#define ERROR_l(line) report_error(line, 'l')
+#define ERROR_m(line) report_error(line, 'm')
+
+// 按行号排序后输出错误，写出失败时返回 false
+bool write_error_file(const char* error_path) {
+    ArtifactWriter outfile;
+    if (!outfile.open(error_path)) {
+        fprintf(stderr, "Error: Failed to open error file for writing: %s\n", error_path);
+        return false;
     }
-    infile.close();
 
     // 排序：按行号从小到大排序
-    std::sort(records.begin(), records.end(),
+    std::sort(g_error_records.begin(), g_error_records.end(),
               [](const FileErrorRecord& a, const FileErrorRecord& b) {
                   return a.line < b.line;
               });
 
-    // 将排序后的结果写回文件 (使用 std::ofstream 自动覆盖)
-    std::ofstream outfile(error_path);
-    if (!outfile.is_open()) {
-        fprintf(stderr, "Error: Failed to open error file for sorting rewrite: %s\n", error_path);
-        return;
+    for (const auto& record : g_error_records) {
+        outfile.write(record.line);
+        outfile.write(' ');
+        outfile.write(record.type);
+        outfile.write('\n');
     }
-
-    for (const auto& record : records) {
-        outfile << record.line << " " << record.type << "\n";
-    }
-
-    outfile.close();
+    return true;
 }
 
 void pretreatment(const char* getfilepath, const char* putfilepath) {
@@ -195,174 +368,180 @@ void pretreatment(const char* getfilepath, const char* putfilepath) {
 
 // --- 词法分析辅助函数 ---
 
-void push_token(const char* type, const char* value, int row) {
-    g_tokens.push_back({std::string(type), std::string(value), row});
+void push_token(TokenKind kind, size_t offset, size_t length, int row) {
+    g_tokens.kinds.push_back(kind);
+    g_tokens.offsets.push_back(static_cast<uint32_t>(offset));
+    g_tokens.lengths.push_back(static_cast<uint32_t>(length));
+    g_tokens.lines.push_back(row);
 }
 
-// [省略 pretreatment 函数，假设其能正确处理注释]
-
-void lexical_analysis(const char* getfilepath, const char* putlexerpath, const char* puterrorpath) {
-    FILE* yuchli = fopen(getfilepath, "r");
-    if (yuchli == nullptr) { exit(1); }
-
-    // 打开错误文件
-    g_error_file = fopen(puterrorpath, "w");
-    if (g_error_file == nullptr) { fclose(yuchli); exit(1); }
+// 把整个文件读入 buffer，文件无法打开时返回 false
+bool read_source(const char* path, std::string& buffer) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    buffer.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    buffer.resize(fread(&buffer[0], 1, buffer.size(), file));
+    fclose(file);
+    return true;
+}
 
+// * 单遍词法分析：源文件一次读入 g_tokens.text，扫描时直接跳过注释并统计行号，
+// 词素记录为源文本中的偏移；源文本中不存在的词素（单个 & / | 按 && / || 处理）追加在源文本之后
+// lexer.txt 只在开启时输出，源文件无法打开时返回 false
+bool lexical_analysis(const char* getfilepath, const char* putlexerpath) {
     g_tokens.clear();
-    int ch;
-    char token_buf[MAX_TOKEN_LEN] = {};
+    if (!read_source(getfilepath, g_tokens.text)) return false;
+
+    const std::string& src = g_tokens.text;
+    const size_t n = src.size(); // 只扫描源文本部分
+    auto at = [&](size_t k) -> int { return k < n ? static_cast<unsigned char>(src[k]) : EOF; };
+    auto synthetic = [&](const char* lexeme) {
+        size_t offset = g_tokens.text.size();
+        g_tokens.text += lexeme;
+        return offset;
+    };
+    size_t pos = 0;
     int row = 1;
 
-    while ((ch = fgetc(yuchli)) != EOF) {
-        if (std::isspace(ch)) { if (ch == '\n') row++; continue; }
-
-        if (ch > 0 && (std::isalpha(ch) || ch == '_')) {
-            // 标识符/关键字 (不变)
-            int tokenindex = 0;
-            const char* token_type = "IDENFR";
-            // ... (省略实现细节，假设正确)
-            token_buf[tokenindex++] = static_cast<char>(ch);
-            while ((ch = fgetc(yuchli)) != EOF && ch > 0 && (std::isalnum(ch) || ch == '_')) {
-                if (tokenindex < MAX_TOKEN_LEN - 1) token_buf[tokenindex++] = static_cast<char>(ch);
-                else { ungetc(ch, yuchli); break; }
-            }
-            if (ch != EOF) ungetc(ch, yuchli);
-            token_buf[tokenindex] = '\0';
-            for (int i = 0; i < KEYWORD_COUNT; i++) {
-                if (std::strcmp(token_buf, keywords[i]) == 0) {
+    while (pos < n) {
+        int ch = at(pos);
+        if (std::isspace(ch)) { if (ch == '\n') row++; pos++; continue; }
+
+        // 注释：单行注释保留换行交给空白处理，多行注释内的换行照常计行
+        if (ch == '/' && at(pos + 1) == '/') {
+            pos += 2;
+            while (pos < n && src[pos] != '\n') pos++;
+            continue;
+        }
+        if (ch == '/' && at(pos + 1) == '*') {
+            pos += 2;
+            int prev_ch = 0;
+            while (pos < n) {
+                ch = at(pos++);
+                if (ch == '/' && prev_ch == '*') break;
+                prev_ch = ch;
+                if (ch == '\n') row++;
+            }
+            continue;
+        }
+
+        size_t start = pos;
+        if (std::isalpha(ch) || ch == '_') {
+            // 标识符/关键字
+            while (pos < n && (std::isalnum(at(pos)) || at(pos) == '_')) pos++;
+            std::string_view word(src.data() + start, pos - start);
+            TokenKind token_type = TokenKind::IDENFR;
+            for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+                if (word == keywords[i]) {
                     token_type = keymap[i];
                     break;
                 }
             }
-            push_token(token_type, token_buf, row);
+            push_token(token_type, start, pos - start, row);
             continue;
         }
 
-        else if (ch > 0 && std::isdigit(ch)) {
-            // 常数 (不变)
-            int tokenindex = 0;
-            token_buf[tokenindex++] = static_cast<char>(ch);
-            while ((ch = fgetc(yuchli)) != EOF && ch > 0 && std::isdigit(ch)) {
-                if (tokenindex < MAX_TOKEN_LEN - 1) token_buf[tokenindex++] = static_cast<char>(ch);
-                else { ungetc(ch, yuchli); break; }
-            }
-            if (ch != EOF) ungetc(ch, yuchli);
-            token_buf[tokenindex] = '\0';
-            push_token("INTCON", token_buf, row);
+        else if (std::isdigit(ch)) {
+            // 常数
+            while (pos < n && std::isdigit(at(pos))) pos++;
+            push_token(TokenKind::INTCON, start, pos - start, row);
             continue;
         }
 
         else if (ch == '"') {
-            // 字符串 (InitVal 中允许)
-            int tokenindex = 0;
-            token_buf[tokenindex++] = static_cast<char>(ch);
-            while ((ch = fgetc(yuchli)) != EOF && ch != '\n') {
-                if (ch == '"') {
-                    token_buf[tokenindex++] = static_cast<char>(ch);
-                    token_buf[tokenindex] = '\0';
-                    push_token("STRCON", token_buf, row);
-                    break;
-                }
-                token_buf[tokenindex++] = static_cast<char>(ch);
-            }
-            if (ch == '\n' || ch == EOF) {
-                fprintf(g_error_file, "%d a\n", row); // 非法符号 a
+            // 字符串 (InitVal 中允许)，不能跨行
+            pos++;
+            while (pos < n && src[pos] != '"' && src[pos] != '\n') pos++;
+            if (pos < n && src[pos] == '"') {
+                pos++;
+                push_token(TokenKind::STRCON, start, pos - start, row);
+            } else {
+                ERROR_a(row); // 非法符号 a
             }
             continue;
         }
 
-        else if (ch > 0 && std::isgraph(ch)) {
+        else if (std::isgraph(ch)) {
             // 运算符与界符 (重点处理 '&' 和 '|')
-            const char* token_type = nullptr;
-            int next_ch;
-            token_buf[0] = '\0';
+            TokenKind token_type;
+            size_t length = 1;
+            pos++;
 
             switch (ch) {
                 case '&':
-                    next_ch = fgetc(yuchli);
-                    if (next_ch == '&') { token_type = "AND"; std::strcpy(token_buf, "&&"); }
-                    else { ungetc(next_ch, yuchli);
-                        fprintf(g_error_file, "%d a\n", row); // 输出错误 a
-
-                        // **强制作为 '&&' 处理并继续**
-                        token_type = "AND";
-                        std::strcpy(token_buf, "&&"); }
-                    break;
                 case '|':
-                    next_ch = fgetc(yuchli);
-                    if (next_ch == '|') { token_type = "OR"; std::strcpy(token_buf, "||"); }
-                    else { ungetc(next_ch, yuchli);
-                        fprintf(g_error_file, "%d a\n", row); // 输出错误 a
-
-                        // **强制作为 '&&' 处理并继续**
-                        token_type = "OR";
-                        std::strcpy(token_buf, "||"); }
+                    token_type = ch == '&' ? TokenKind::AND : TokenKind::OR;
+                    if (at(pos) == ch) {
+                        pos++;
+                        length = 2;
+                    } else {
+                        ERROR_a(row); // 输出错误 a
+
+                        // **强制作为 '&&' / '||' 处理并继续**
+                        start = synthetic(ch == '&' ? "&&" : "||");
+                        length = 2;
+                    }
                     break;
-                case '+':
-                    token_type = "PLUS"; token_buf[0] = '+'; token_buf[1] = '\0'; break;
-                case '-':
-                    token_type = "MINU"; token_buf[0] = '-'; token_buf[1] = '\0'; break;
-                case '*':
-                    token_type = "MULT"; token_buf[0] = '*'; token_buf[1] = '\0'; break;
-                case '/':
-                    token_type = "DIV"; token_buf[0] = '/'; token_buf[1] = '\0'; break;
-                case '%':
-                    token_type = "MOD"; token_buf[0] = '%'; token_buf[1] = '\0'; break;
+                case '+': token_type = TokenKind::PLUS; break;
+                case '-': token_type = TokenKind::MINU; break;
+                case '*': token_type = TokenKind::MULT; break;
+                case '/': token_type = TokenKind::DIV; break;
+                case '%': token_type = TokenKind::MOD; break;
                 case '!':
                 case '=':
                 case '<':
                 case '>':
-                    next_ch = fgetc(yuchli);
-                    token_buf[0] = static_cast<char>(ch);
-                    if (next_ch == '=') {
-                        token_buf[1] = '='; token_buf[2] = '\0';
-                        if (ch == '!') token_type = "NEQ";
-                        else if (ch == '=') token_type = "EQL";
-                        else if (ch == '<') token_type = "LEQ";
-                        else if (ch == '>') token_type = "GEQ";
+                    if (at(pos) == '=') {
+                        pos++;
+                        length = 2;
+                        if (ch == '!') token_type = TokenKind::NEQ;
+                        else if (ch == '=') token_type = TokenKind::EQL;
+                        else if (ch == '<') token_type = TokenKind::LEQ;
+                        else token_type = TokenKind::GEQ;
                     } else {
-                        ungetc(next_ch, yuchli);
-                        token_buf[1] = '\0';
-                        if (ch == '!') token_type = "NOT";
-                        else if (ch == '=') token_type = "ASSIGN";
-                        else if (ch == '<') token_type = "LSS";
-                        else if (ch == '>') token_type = "GRE";
+                        if (ch == '!') token_type = TokenKind::NOT;
+                        else if (ch == '=') token_type = TokenKind::ASSIGN;
+                        else if (ch == '<') token_type = TokenKind::LSS;
+                        else token_type = TokenKind::GRE;
                     }
                     break;
-                case '(': token_type = "LPARENT"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case ')': token_type = "RPARENT"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case '[': token_type = "LBRACK"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case ']': token_type = "RBRACK"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case '{': token_type = "LBRACE"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case '}': token_type = "RBRACE"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case ';': token_type = "SEMICN"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
-                case ',': token_type = "COMMA"; token_buf[0] = static_cast<char>(ch); token_buf[1] = '\0'; break;
+                case '(': token_type = TokenKind::LPARENT; break;
+                case ')': token_type = TokenKind::RPARENT; break;
+                case '[': token_type = TokenKind::LBRACK; break;
+                case ']': token_type = TokenKind::RBRACK; break;
+                case '{': token_type = TokenKind::LBRACE; break;
+                case '}': token_type = TokenKind::RBRACE; break;
+                case ';': token_type = TokenKind::SEMICN; break;
+                case ',': token_type = TokenKind::COMMA; break;
                 default:
-                    fprintf(g_error_file, "%d a\n", row); // 非法符号 a
+                    ERROR_a(row); // 非法符号 a
                     continue;
             }
 
-            if (token_type != nullptr) {
-                push_token(token_type, token_buf, row);
-            }
+            push_token(token_type, start, length, row);
             continue;
         }
 
         else {
-            fprintf(g_error_file, "%d a\n", row); // 非法符号 a
+            ERROR_a(row); // 非法符号 a
+            pos++;
             continue;
         }
     }
 
-    FILE* cifa = fopen(putlexerpath, "w");
-    if(cifa != nullptr){
-        for(const auto& tok : g_tokens) { fprintf(cifa, "%s %s\n", tok.type.c_str(), tok.value.c_str()); }
-        fclose(cifa);
+    ArtifactWriter cifa;
+    if (g_artifacts.lexer && cifa.open(putlexerpath)) {
+        for (size_t i = 0; i < g_tokens.size(); ++i) {
+            cifa.write(token_kind_name(g_tokens.kinds[i]));
+            cifa.write(' ');
+            cifa.write(g_tokens.lexeme(i));
+            cifa.write('\n');
+        }
     }
-
-    fclose(yuchli);
-    //if(g_error_file) fclose(g_error_file);
+    return true;
 }
 
 class IRGenerator {
@@ -492,7 +671,8 @@ class Parser {
 private:
     size_t current_index;
     bool basic_block_terminated = false;
-    FILE* output_file;
+    ArtifactWriter output_file; // parser.txt，未开启时不打开
+    const char* error_path;     // error.txt 路径，遇到无法恢复的语法错误时先写出已记录的错误
     SymbolTable g_builtin_symbols;
     std::stack<std::string> continue_label_stack;
     std::stack<std::string> break_label_stack;
@@ -545,35 +725,49 @@ private:
 
         return s.type; // 如果 type 是 "void"，但不是函数，不应该出现。如果出现，直接返回 "void" 或 "UnknownType"。
     }
-    const Token& current_token() {
-        if (current_index < g_tokens.size()) { return g_tokens[current_index]; }
-        static const Token eof_token = {"EOF", "", -1}; return eof_token;
+    Token token_at(size_t index) const {
+        if (index < g_tokens.size()) {
+            return {g_tokens.kinds[index], g_tokens.lexeme(index), g_tokens.lines[index]};
+        }
+        return {TokenKind::END, "", -1};
     }
 
-    const Token& peek(int offset) {
-        if (current_index + offset < g_tokens.size()) { return g_tokens[current_index + offset]; }
-        static const Token eof_token = {"EOF", "", -1}; return eof_token;
+    Token current_token() const { return token_at(current_index); }
+
+    Token peek(int offset) const { return token_at(current_index + offset); }
+
+    // 当前单词的类别（只比较类别时不必构造 Token）
+    TokenKind current_kind() const {
+        return current_index < g_tokens.size() ? g_tokens.kinds[current_index] : TokenKind::END;
     }
 
-    void match(const std::string& expected_type) {
-        const Token& tok = current_token();
-        fprintf(output_file, "%s %s\n", tok.type.c_str(), tok.value.c_str());
+    void print_token(const Token& tok) {
+        if (!output_file.is_open()) return;
+        output_file.write(token_kind_name(tok.kind));
+        output_file.write(' ');
+        output_file.write(tok.value);
+        output_file.write('\n');
+    }
+
+    void match(TokenKind expected_type) {
+        const Token tok = current_token();
+        print_token(tok);
 
-        if (tok.type == expected_type) {
+        if (tok.kind == expected_type) {
             current_index++;
         } else {
             fprintf(stderr, "Syntax Error at line %d: Expected %s, got %s\n",
-                    tok.line, expected_type.c_str(), tok.type.c_str());
-            exit(1);
+                    tok.line, token_kind_name(expected_type), token_kind_name(tok.kind));
+            abort_parse();
         }
     }
 
-    void match_with_error_check(const std::string& expected_type, char error_type, int error_line) {
-        const Token& tok = current_token();
+    void match_with_error_check(TokenKind expected_type, char error_type, int error_line) {
+        const Token tok = current_token();
 
-        if (tok.type == expected_type) {
+        if (tok.kind == expected_type) {
             // 1. 匹配成功：输出 Token 并推进索引
-            fprintf(output_file, "%s %s\n", tok.type.c_str(), tok.value.c_str());
+            print_token(tok);
             current_index++;
         } else {
             // 2. 匹配失败：报告错误并尝试恢复
@@ -589,27 +783,36 @@ private:
                 // 否则（如果有其他错误类型传入，理论上不应该，但作为安全措施）
             else {
                 fprintf(stderr, "Unexpected soft syntax error: Expected %s, got %s\n",
-                        expected_type.c_str(), tok.type.c_str());
+                        token_kind_name(expected_type), token_kind_name(tok.kind));
             }
             const char* token_value = "";
-            if (expected_type == "SEMICN") {
+            if (expected_type == TokenKind::SEMICN) {
                 token_value = ";";
-            } else if (expected_type == "RPARENT") {
+            } else if (expected_type == TokenKind::RPARENT) {
                 token_value = ")";
-            } else if (expected_type == "RBRACK") {
+            } else if (expected_type == TokenKind::RBRACK) {
                 token_value = "]";
             }
 
             // **关键步骤：将缺失的 Token 类型和符号值写入 parser.txt**
-            fprintf(output_file, "%s %s\n", expected_type.c_str(), token_value);
+            print_token({expected_type, token_value, error_line});
             // 3. 错误恢复策略:
             //    - 不消耗当前的错误 Token (current_index 不变)。
             //    - 允许解析器继续执行下一个匹配或非终结符的规则。
             //    - 因为Token不存在，所以不输出到 output_file。
         }
     }
+    // 无法恢复的语法错误：写出已生成的产物后退出
+    [[noreturn]] void abort_parse() {
+        output_file.close();
+        if (g_artifacts.error) write_error_file(error_path);
+        exit(1);
+    }
     void print_non_terminal(const char* name) {
-        fprintf(output_file, "<%s>\n", name);
+        if (!output_file.is_open()) return;
+        output_file.write('<');
+        output_file.write(name);
+        output_file.write(">\n");
     }
     IRValue ensure_i32(IRValue val) {
         if (val.type == "i32") return val;
@@ -629,18 +832,18 @@ private:
     void enter_scope() {
         g_scope_counter++;
         g_active_scope_ids.push(g_scope_counter);
-        g_scope_stack.push_back({});
+        g_symbols.enter_scope();
     }
 
     void exit_scope() {
-        g_scope_stack.pop_back();
+        g_symbols.exit_scope();
         if (!g_active_scope_ids.empty()) {
             g_active_scope_ids.pop();
         }
     }
     // 检查当前作用域是否重复定义 (错误 b)
     bool check_redefinition(const std::string& name, int line) {
-        if (g_scope_stack.back().count(name)) {
+        if (g_symbols.find_local(name)) {
             ERROR_b(line);
             // 报告错误 b
             // ERROR_b(line);
@@ -649,35 +852,23 @@ private:
         return false;
     }
 
-    // 查找符号
-    bool find_symbol(const std::string& name, Symbol& found_symbol) {
-        for (auto it = g_scope_stack.rbegin(); it != g_scope_stack.rend(); ++it) {
-            if (it->count(name)) {
-                // 找到符号，将其信息存储到 found_symbol 中
-                found_symbol = it->at(name);
-                return true;
-            }
-        }
-        if (g_builtin_symbols.count(name)) {
-            found_symbol = g_builtin_symbols.at(name);
-            return true;
-        }
-        return false;
+    // 查找符号，未定义时返回 nullptr
+    const Symbol* find_symbol(const std::string& name) {
+        if (const Symbol* symbol = g_symbols.find(name)) return symbol;
+        auto builtin = g_builtin_symbols.find(name);
+        return builtin != g_builtin_symbols.end() ? &builtin->second : nullptr;
     }
     Symbol& lookup_symbol(const std::string& name) {
-        // 1. 查找作用域栈
-        // 从最内层作用域（栈顶）开始向外查找
-        for (auto it = g_scope_stack.rbegin(); it != g_scope_stack.rend(); ++it) {
-            if (it->count(name)) {
-                // 找到符号，返回其在 map 中的引用
-                return it->at(name);
-            }
+        // 1. 查找作用域符号表（最内层可见的定义）
+        if (Symbol* symbol = g_symbols.find(name)) {
+            return *symbol;
         }
 
         // 2. 查找内置符号
-        if (g_builtin_symbols.count(name)) {
+        auto builtin = g_builtin_symbols.find(name);
+        if (builtin != g_builtin_symbols.end()) {
             // 返回内置符号的引用
-            return g_builtin_symbols.at(name);
+            return builtin->second;
         }
 
         // 3. 错误处理
@@ -689,7 +880,8 @@ private:
     void add_symbol(const std::string& name,  Symbol symbol, int line) {
         if (!check_redefinition(name, line)) {
             //symbol.scope_id = g_scope_counter;
-            g_scope_stack.back()[name] = symbol;
+            g_symbols.insert(name, symbol);
+            if (!g_artifacts.symbol) return;
 
             std::string type_name = infer_type_name(symbol); // 需要实现这个辅助函数
             g_symbol_output_records.push_back({
@@ -706,8 +898,7 @@ private:
 
     // 检查变量是否已定义 (错误 c)
     bool check_variable_declared(const std::string& name, int line) {
-        Symbol temp;
-        if (!find_symbol(name, temp)) {
+        if (!find_symbol(name)) {
             ERROR_c(line);
             return false;
         }else{
@@ -721,7 +912,7 @@ private:
 
     // BType -> 'int'
     void parseBType(std::string& type_out) {
-        match("INTTK");
+        match(TokenKind::INTTK);
         type_out = "int";
         //print_non_terminal("BType");
     }
@@ -736,24 +927,24 @@ private:
 //        add_symbol("getint", {"getint", "int", false, false, {}, 0, 1, 0, {}}, 0); // 返回 int, 0 个参数
 //        add_symbol("printf", {"printf", "void", false, false, {}, 0, 1, -1, {}}, 0); // 返回 void, -1 表示参数可变或不检查
 
-        while (current_token().type != "EOF") {
-            const Token& T1 = current_token();
-            const Token& T2 = peek(1);
-            const Token& T3 = peek(2);
+        while (current_kind() != TokenKind::END) {
+            const Token T1 = current_token();
+            const Token T2 = peek(1);
+            const Token T3 = peek(2);
 
             // 1. 检查是否是 MainFuncDef 的开头 (int main( ) )
-            if (T1.type == "INTTK" && T2.type == "MAINTK" && T3.type == "LPARENT") {
+            if (T1.kind == TokenKind::INTTK && T2.kind == TokenKind::MAINTK && T3.kind == TokenKind::LPARENT) {
                 break; // 找到了主函数，退出循环
             }
 
             // 2. 检查是否是 FuncDef 的开头 ( FuncType Ident ( ) )
-            if ((T1.type == "INTTK" || T1.type == "VOIDTK") && T2.type == "IDENFR" && T3.type == "LPARENT") {
+            if ((T1.kind == TokenKind::INTTK || T1.kind == TokenKind::VOIDTK) && T2.kind == TokenKind::IDENFR && T3.kind == TokenKind::LPARENT) {
                 parseFuncDef();
                 continue;
             }
 
             // 3. 检查是否是 Decl 的开头 (ConstDecl or VarDecl)
-            if (T1.type == "CONSTTK" || T1.type == "STATICTK" || T1.type == "INTTK") {
+            if (T1.kind == TokenKind::CONSTTK || T1.kind == TokenKind::STATICTK || T1.kind == TokenKind::INTTK) {
                 parseDecl();
                 continue;
             }
@@ -770,7 +961,7 @@ private:
 
     // Decl -> ConstDecl | VarDecl
     void parseDecl() {
-        if (current_token().type == "CONSTTK") {
+        if (current_kind() == TokenKind::CONSTTK) {
             parseConstDecl();
         } else { // VarDecl: [ 'static' ] BType VarDef ...
             parseVarDecl();
@@ -780,28 +971,29 @@ private:
 
     // ConstDecl -> 'const' BType ConstDef { ',' ConstDef } ';'
     void parseConstDecl() {
-        match("CONSTTK");
+        match(TokenKind::CONSTTK);
         std::string type;
         parseBType(type); // 匹配 BType ('int')
 
         parseConstDef(type);
-        while (current_token().type == "COMMA") {
-            match("COMMA");
+        while (current_kind() == TokenKind::COMMA) {
+            match(TokenKind::COMMA);
             parseConstDef(type);
         }
-        match_with_error_check("SEMICN", 'i', peek(-1).line);
+        match_with_error_check(TokenKind::SEMICN, 'i', peek(-1).line);
         print_non_terminal("ConstDecl");
     }
 
     // ConstDef -> Ident [ '[' ConstExp ']' ] '=' ConstInitVal
     void parseConstDef(const std::string& type) {
         Token ident_tok = current_token();
-        match("IDENFR");
+        const std::string ident_name(ident_tok.value);
+        match(TokenKind::IDENFR);
 
         std::vector<int> dimensions;
         int total_array_size = 1;
-        while (current_token().type == "LBRACK") {
-            match("LBRACK");
+        while (current_kind() == TokenKind::LBRACK) {
+            match(TokenKind::LBRACK);
             bool old_ctx = is_const_context;
             is_const_context = true;
             parseConstExp();
@@ -816,11 +1008,11 @@ private:
                 dim_size = 1;
             }
             dimensions.push_back(dim_size);
-            match_with_error_check("RBRACK", 'k', peek(-1).line);
+            match_with_error_check(TokenKind::RBRACK, 'k', peek(-1).line);
             //dimensions.push_back(0); // 占位
         }
 
-        Symbol new_const = {ident_tok.value, type, true, false, dimensions, ident_tok.line};
+        Symbol new_const = {ident_name, type, true, false, dimensions, ident_tok.line};
         if (!g_active_scope_ids.empty()) {
             new_const.scope_id = g_active_scope_ids.top(); // <-- 使用当前活跃的作用域 ID (即 9)
         } else {
@@ -834,12 +1026,12 @@ private:
             // 【修改点】区分全局和局部常量数组的命名
             if (new_const.scope_id == 1) {
                 // 全局作用域：直接使用标识符
-                global_name = "@" + ident_tok.value;
+                global_name = "@" + ident_name;
                 new_const.is_global = true;
             } else {
                 // 局部作用域：常量数组在 LLVM 中通常提升为全局常量数据，
                 // 为了防止不同函数内定义了同名常量数组导致冲突，必须添加 scope_id 后缀
-                global_name = "@" + ident_tok.value + "_" + std::to_string(new_const.scope_id);
+                global_name = "@" + ident_name + "_" + std::to_string(new_const.scope_id);
             }
             new_const.llvm_name = global_name;
 
@@ -854,7 +1046,7 @@ private:
         }
         //add_symbol(ident_tok.value, new_const, ident_tok.line);
 
-        match("ASSIGN");
+        match(TokenKind::ASSIGN);
         size_t initial_stack_size = const_value_stack.size();
         is_const_context = true;
         parseConstInitVal();
@@ -915,22 +1107,22 @@ private:
 //                g_scope_stack.back()[ident_tok.value] = new_const;
 //            }
         }
-        add_symbol(ident_tok.value, new_const, ident_tok.line);
+        add_symbol(ident_name, new_const, ident_tok.line);
         print_non_terminal("ConstDef");
     }
 
     // ConstInitVal -> ConstExp | '{' [ ConstExp { ',' ConstExp } ] '}'
     void parseConstInitVal() {
-        if (current_token().type == "LBRACE") {
-            match("LBRACE");
-            if (current_token().type != "RBRACE") {
+        if (current_kind() == TokenKind::LBRACE) {
+            match(TokenKind::LBRACE);
+            if (current_kind() != TokenKind::RBRACE) {
                 parseConstExp();
-                while (current_token().type == "COMMA") {
-                    match("COMMA");
+                while (current_kind() == TokenKind::COMMA) {
+                    match(TokenKind::COMMA);
                     parseConstExp();
                 }
             }
-            match("RBRACE");
+            match(TokenKind::RBRACE);
         } else {
             parseConstExp();
         }
@@ -941,8 +1133,8 @@ private:
     // VarDecl -> [ 'static' ] BType VarDef { ',' VarDef } ';'
     void parseVarDecl() {
         bool is_static = false;
-        if (current_token().type == "STATICTK") {
-            match("STATICTK");
+        if (current_kind() == TokenKind::STATICTK) {
+            match(TokenKind::STATICTK);
             is_static = true;
         }
 
@@ -950,31 +1142,30 @@ private:
         parseBType(type);
 
         parseVarDef(type, is_static);
-        while (current_token().type == "COMMA") {
-            match("COMMA");
+        while (current_kind() == TokenKind::COMMA) {
+            match(TokenKind::COMMA);
             parseVarDef(type, is_static);
         }
-        match_with_error_check("SEMICN", 'i', peek(-1).line);
+        match_with_error_check(TokenKind::SEMICN, 'i', peek(-1).line);
         print_non_terminal("VarDecl");
     }
     IRValue parseConstInitValIR() {
-        if (current_token().type == "LBRACE") {
+        if (current_kind() == TokenKind::LBRACE) {
             // 数组初始化：这里需要实现数组常量聚合体的求值，但目前可以先跳过
-            match("LBRACE");
-            if (current_token().type != "RBRACE") {
+            match(TokenKind::LBRACE);
+            if (current_kind() != TokenKind::RBRACE) {
                 // 对于数组初始化，递归调用 parseConstInitValIR 或 parseConstExp
                 parseConstExp();
-                while (current_token().type == "COMMA") {
-                    match("COMMA");
+                while (current_kind() == TokenKind::COMMA) {
+                    match(TokenKind::COMMA);
                     parseConstExp();
                 }
             }
-            match_with_error_check("RBRACE", 'k', peek(-1).line);
+            match_with_error_check(TokenKind::RBRACE, 'k', peek(-1).line);
             // 对于 int arr[3] = {1}; 这种，如果只解析到第一个元素，返回第一个元素的字面量
             return {"0", "i32"};
-        } else if (current_token().type == "STRCON") {
-            Token t = current_token();
-            match("STRCON");
+        } else if (current_kind() == TokenKind::STRCON) {
+            match(TokenKind::STRCON);
             // 全局字符串常量定义是合法的，这里保持调用 define_string
             print_non_terminal("ConstInitVal");
             // 对于数组常量初始化，返回 LLVM 的零初始化常量（或后续的聚合常量）
@@ -994,21 +1185,22 @@ private:
     // VarDef -> Ident [ '[' ConstExp ']' ] [ '=' InitVal ]
     void parseVarDef(const std::string& type, bool is_static) {
         Token ident_tok = current_token();
-        match("IDENFR");
+        const std::string ident_name(ident_tok.value);
+        match(TokenKind::IDENFR);
 
         std::vector<int> dimensions;
-        while (current_token().type == "LBRACK") {
-            match("LBRACK");
+        while (current_kind() == TokenKind::LBRACK) {
+            match(TokenKind::LBRACK);
             IRValue array_size_ir = parseConstExp();
             int array_size = 0;
             try {
                 array_size = std::stoi(array_size_ir.name);
             } catch (...) { array_size = 1; }
-            match_with_error_check("RBRACK", 'k', peek(-1).line);
+            match_with_error_check(TokenKind::RBRACK, 'k', peek(-1).line);
             dimensions.push_back(array_size);
         }
 
-        Symbol new_var = {ident_tok.value, type, false, is_static, dimensions, ident_tok.line};
+        Symbol new_var = {ident_name, type, false, is_static, dimensions, ident_tok.line};
         if (!g_active_scope_ids.empty()) {
             new_var.scope_id = g_active_scope_ids.top();
         } else {
@@ -1034,19 +1226,19 @@ private:
         if (is_global || new_var.is_const || is_static) {
             // 全局/静态变量：生成 global 定义
             if (is_global) {
-                new_var.llvm_name = "@" + ident_tok.value;
+                new_var.llvm_name = "@" + ident_name;
             } else {
-                new_var.llvm_name = "@" + ident_tok.value + "_" + std::to_string(new_var.scope_id);
+                new_var.llvm_name = "@" + ident_name + "_" + std::to_string(new_var.scope_id);
             }
         } else {
             // 局部变量
             if (dimensions.empty()) {
-                new_var.llvm_name = "%" + ident_tok.value + "_" + std::to_string(new_var.scope_id) + "_addr";
+                new_var.llvm_name = "%" + ident_name + "_" + std::to_string(new_var.scope_id) + "_addr";
                 std::string alloca_ir = "  " + new_var.llvm_name + " = alloca i32, align 4";
                 if (!alloca_buffers.empty()) alloca_buffers.top() << alloca_ir << "\n";
                 else ir_generator.write_alloca(alloca_ir);
             } else {
-                new_var.llvm_name = "%arr_" + ident_tok.value + "_" + std::to_string(new_var.scope_id);
+                new_var.llvm_name = "%arr_" + ident_name + "_" + std::to_string(new_var.scope_id);
                 std::string alloca_ir = "  " + new_var.llvm_name + " = alloca " + array_ir_type + ", align 4";
                 if (!alloca_buffers.empty()) alloca_buffers.top() << alloca_ir << "\n";
                 else ir_generator.write_alloca(alloca_ir);
@@ -1058,8 +1250,8 @@ private:
         // ----------------------------------------------------
         // 步骤 2: 处理初始化 (InitVal)
         // ----------------------------------------------------
-        if (current_token().type == "ASSIGN") {
-            match("ASSIGN");
+        if (current_kind() == TokenKind::ASSIGN) {
+            match(TokenKind::ASSIGN);
 
             if (is_global || new_var.is_const || is_static) {
                 // --- 编译时常量初始化 ---
@@ -1111,10 +1303,10 @@ private:
                     ir_generator.write_func("store i32 " + init_val.name + ", i32* " + new_var.llvm_name + ", align 4");
                 } else {
                     // 数组：解析 { exp, ... } 并逐个 store
-                    if (current_token().type == "LBRACE") {
-                        match("LBRACE");
+                    if (current_kind() == TokenKind::LBRACE) {
+                        match(TokenKind::LBRACE);
                         int idx = 0;
-                        if (current_token().type != "RBRACE") {
+                        if (current_kind() != TokenKind::RBRACE) {
                             do {
                                 // 解析每个元素表达式
                                 IRValue val = parseExp();
@@ -1128,14 +1320,14 @@ private:
                                 ir_generator.write_func("store i32 " + val.name + ", i32* " + gep_reg + ", align 4");
 
                                 idx++;
-                                if (current_token().type == "COMMA") {
-                                    match("COMMA");
+                                if (current_kind() == TokenKind::COMMA) {
+                                    match(TokenKind::COMMA);
                                 } else {
                                     break;
                                 }
                             } while (true);
                         }
-                        match_with_error_check("RBRACE", 'k', peek(-1).line);
+                        match_with_error_check(TokenKind::RBRACE, 'k', peek(-1).line);
                     }
                     print_non_terminal("InitVal");
                 }
@@ -1148,31 +1340,31 @@ private:
                 ir_generator.write_global(new_var.llvm_name + " = global " + type_str + " " + init_str + ", align 4");
             }
         }
-        add_symbol(ident_tok.value, new_var, ident_tok.line);
+        add_symbol(ident_name, new_var, ident_tok.line);
         print_non_terminal("VarDef");
     }
     IRValue parseInitValIR() {
         // 支持三类： 1) 字符串 2) 花括号列表（暂不做数组逐元素赋值到 IR） 3) 单个表达式
-        if (current_token().type == "LBRACE") {
+        if (current_kind() == TokenKind::LBRACE) {
             // 数组初始化（我们先做语义分析，IR 先简化为 0 占位）
-            match("LBRACE");
-            if (current_token().type != "RBRACE") {
+            match(TokenKind::LBRACE);
+            if (current_kind() != TokenKind::RBRACE) {
                 parseExp();
-                while (current_token().type == "COMMA") {
-                    match("COMMA");
+                while (current_kind() == TokenKind::COMMA) {
+                    match(TokenKind::COMMA);
                     parseExp();
                 }
             }
-            match_with_error_check("RBRACE", 'k', peek(-1).line);
+            match_with_error_check(TokenKind::RBRACE, 'k', peek(-1).line);
             // 返回常量 0 作为临时值（用户如果要数组初始化应另行实现）
             print_non_terminal("InitVal");
             return {"0", "i32"};
-        } else if (current_token().type == "STRCON") {
+        } else if (current_kind() == TokenKind::STRCON) {
             Token t = current_token();
-            match("STRCON");
+            match(TokenKind::STRCON);
             // 使用 IRGenerator 生成全局 string 常量并返回 i8*
             print_non_terminal("InitVal");
-            return ir_generator.define_string(t.value);
+            return ir_generator.define_string(std::string(t.value));
         } else {
             // 普通表达式
             print_non_terminal("InitVal");
@@ -1183,18 +1375,18 @@ private:
 
     // InitVal -> Exp | '{' [ Exp { ',' Exp } ] '}' | StringConst (STRCON)
     void parseInitVal() {
-        if (current_token().type == "LBRACE") {
-            match("LBRACE");
-            if (current_token().type != "RBRACE") {
+        if (current_kind() == TokenKind::LBRACE) {
+            match(TokenKind::LBRACE);
+            if (current_kind() != TokenKind::RBRACE) {
                 parseExp();
-                while (current_token().type == "COMMA") {
-                    match("COMMA");
+                while (current_kind() == TokenKind::COMMA) {
+                    match(TokenKind::COMMA);
                     parseExp();
                 }
             }
-            match("RBRACE");
-        } else if (current_token().type == "STRCON") {
-            match("STRCON");
+            match(TokenKind::RBRACE);
+        } else if (current_kind() == TokenKind::STRCON) {
+            match(TokenKind::STRCON);
         } else {
             parseExp();
         }
@@ -1203,11 +1395,11 @@ private:
 
     // FuncType -> 'void' | 'int'
     void parseFuncType(std::string& type_out) {
-        if (current_token().type == "VOIDTK") {
-            match("VOIDTK");
+        if (current_kind() == TokenKind::VOIDTK) {
+            match(TokenKind::VOIDTK);
             type_out = "void";
         } else {
-            match("INTTK");
+            match(TokenKind::INTTK);
             type_out = "int";
         }
         print_non_terminal("FuncType");
@@ -1219,12 +1411,13 @@ private:
         parseFuncType(func_type);
 
         Token ident_tok = current_token();
-        match("IDENFR");
+        const std::string ident_name(ident_tok.value);
+        match(TokenKind::IDENFR);
 
         // 1. 初始化 Symbol，并立即添加到全局作用域 (Scope 1)
         // 此时 func_type 尚未包含参数信息，但必须包含正确的返回类型。
         Symbol func_symbol = {
-                ident_tok.value,
+                ident_name,
                 func_type, // 【修正 2：使用 parseFuncType 得到的正确返回类型】
                 false, // is_const: 函数名不是常量
                 false, // is_static
@@ -1234,7 +1427,7 @@ private:
                 0, // param_count 临时值
                 {} // param_types 临时值
         };
-        add_symbol(ident_tok.value, func_symbol, ident_tok.line);
+        add_symbol(ident_name, func_symbol, ident_tok.line);
 
         // 2. 保存外部状态并设置当前函数状态 (用于 G/F 错误追踪)
         std::string original_func_return_type = current_func_return_type;
@@ -1242,7 +1435,7 @@ private:
 //        bool outer_func_return_status = block_contains_return;
 //        block_contains_return = false;
 
-        match("LPARENT");
+        match(TokenKind::LPARENT);
 
         // 3. 进入函数参数/局部变量作用域 (Scope 2)
         enter_scope(); // 【核心修正 1：只调用一次 enter_scope()】
@@ -1251,7 +1444,7 @@ private:
         std::vector<std::string> param_types_for_global;
 
         // 4. 解析参数列表
-        if (current_token().type == "INTTK") {
+        if (current_kind() == TokenKind::INTTK) {
             params_info = parseFuncFParams();
         }
         std::string llvm_param_types_str;
@@ -1278,7 +1471,7 @@ private:
 // 4. 【可选】修正全局符号表中的参数类型信息
 // 确保全局符号表中的函数信息是完整的，用于后续的 d/e 错误检查。
 // 这一步必须在 enter_scope() 之后进行，因为参数 symbol 已经添加到内层作用域。
-        Symbol& global_func_symbol = lookup_symbol(ident_tok.value);
+        Symbol& global_func_symbol = lookup_symbol(ident_name);
         global_func_symbol.param_count = (int)params_info.size();
         global_func_symbol.param_types.clear();
         for (const auto& param : params_info) {
@@ -1307,8 +1500,8 @@ private:
             param_types_for_global.push_back(param_type);
         }
         // 5. 手动更新 Global Scope (Scope 1) 中该函数符号的参数信息
-        if (!g_scope_stack.empty() && g_scope_stack[0].count(ident_tok.value)) {
-            Symbol& global_symbol = g_scope_stack[0].at(ident_tok.value);
+        if (Symbol* global_symbol_ptr = g_symbols.find_global(ident_name)) {
+            Symbol& global_symbol = *global_symbol_ptr;
             global_symbol.param_count = param_types_for_global.size();
             global_symbol.param_types = param_types_for_global; // 存储类型列表
         }
@@ -1341,7 +1534,7 @@ private:
 
 
 // 3. 生成 define 头部和 entry 块
-        std::string func_header_ir = "define " + ret_llvm_type + " @" + ident_tok.value + "(" + llvm_param_names_str + ") {\n";
+        std::string func_header_ir = "define " + ret_llvm_type + " @" + ident_name + "(" + llvm_param_names_str + ") {\n";
         ir_generator.write_func(func_header_ir);
         ir_generator.write_func("entry:");
 
@@ -1369,7 +1562,7 @@ private:
             // 生成 store (将传入的值存入栈地址)
             ir_generator.write_func("  store " + param_llvm_type + " " + incoming_reg + ", " + param_llvm_type + "* " + param_sym.llvm_name + ", align 4");
         }
-        match_with_error_check("RPARENT", 'j', ident_tok.line);
+        match_with_error_check(TokenKind::RPARENT, 'j', ident_tok.line);
         basic_block_terminated = false;
         parseBlock(true);
 //        int rbrace_line = peek(-1).line;
@@ -1423,8 +1616,8 @@ private:
 
     // MainFuncDef -> 'int' 'main' '(' ')' Block
     void parseMainFuncDef() {
-        match("INTTK");
-        match("MAINTK");
+        match(TokenKind::INTTK);
+        match(TokenKind::MAINTK);
         std::string original_return_type = current_func_return_type;
         current_func_return_type = "int";
 
@@ -1438,8 +1631,8 @@ private:
         ir_generator.clear_function_body_ir();
 
         // 匹配括号
-        match("LPARENT");
-        match_with_error_check("RPARENT", 'j', peek(-1).line);
+        match(TokenKind::LPARENT);
+        match_with_error_check(TokenKind::RPARENT, 'j', peek(-1).line);
         ir_generator.reset_register_count();
         // 1. 解析函数体，所有 store, load, call 等指令将写入 function_ir_body 缓冲区
         enter_scope();
@@ -1502,8 +1695,8 @@ private:
         std::vector<ParamInfo> params; // Collect types
         params.push_back(parseFuncFParam()); // 捕获第一个参数的类型
 
-        while (current_token().type == "COMMA") {
-            match("COMMA");
+        while (current_kind() == TokenKind::COMMA) {
+            match(TokenKind::COMMA);
             params.push_back(parseFuncFParam()); // 捕获后续参数的类型
         }
         print_non_terminal("FuncFParams");
@@ -1516,17 +1709,18 @@ private:
         parseBType(type);
 
         Token ident_tok = current_token();
-        match("IDENFR");
+        const std::string ident_name(ident_tok.value);
+        match(TokenKind::IDENFR);
 
         std::vector<int> dimensions;
         bool is_array_param = false;
-        if (current_token().type == "LBRACK") {
-            match("LBRACK");
-            match_with_error_check("RBRACK", 'k', peek(-1).line);
+        if (current_kind() == TokenKind::LBRACK) {
+            match(TokenKind::LBRACK);
+            match_with_error_check(TokenKind::RBRACK, 'k', peek(-1).line);
             dimensions.push_back(0); // 标识为数组指针
             is_array_param = true;
-            while (current_token().type == "LBRACK") {
-                match("LBRACK");
+            while (current_kind() == TokenKind::LBRACK) {
+                match(TokenKind::LBRACK);
                 // 这里必须计算出常量值
                 bool old_ctx = is_const_context;
                 is_const_context = true;
@@ -1537,33 +1731,33 @@ private:
                 try { dim_val = std::stoi(dim_ir.name); } catch(...) {}
                 dimensions.push_back(dim_val);
 
-                match_with_error_check("RBRACK", 'k', peek(-1).line);
+                match_with_error_check(TokenKind::RBRACK, 'k', peek(-1).line);
             }
         }
 
-        Symbol param_symbol = {ident_tok.value, type, false, false, dimensions, ident_tok.line};
+        Symbol param_symbol = {ident_name, type, false, false, dimensions, ident_tok.line};
         param_symbol.scope_id = g_scope_counter;
         param_symbol.is_param = true;
-        param_symbol.llvm_name = "%arg_" + ident_tok.value;
-        add_symbol(ident_tok.value, param_symbol, ident_tok.line);
+        param_symbol.llvm_name = "%arg_" + ident_name;
+        add_symbol(ident_name, param_symbol, ident_tok.line);
         std::string type_str = is_array_param ? "int[]" : "int";
         print_non_terminal("FuncFParam");
-        return {ident_tok.value, type_str};
+        return {ident_name, type_str};
     }
 
     // Block -> '{' { BlockItem } '}'
     bool parseBlock(bool is_func_body) {
-        match("LBRACE");
+        match(TokenKind::LBRACE);
 
         // 引入局部变量追踪该块是否保证返回
         bool block_guarantees_return = false;
 
         // 移除旧的状态保存和重置
 
-        while (current_token().type != "RBRACE" && current_token().type != "EOF") {
-            const Token& T1 = current_token();
+        while (current_kind() != TokenKind::RBRACE && current_kind() != TokenKind::END) {
+            const Token T1 = current_token();
 
-            if (T1.type == "CONSTTK" || T1.type == "STATICTK" || T1.type == "INTTK") {
+            if (T1.kind == TokenKind::CONSTTK || T1.kind == TokenKind::STATICTK || T1.kind == TokenKind::INTTK) {
                 // BlockItem -> Decl
                 parseDecl();
             } else {
@@ -1575,14 +1769,14 @@ private:
             }
         }
 
-        const Token& rbrace_tok = current_token();
+        const Token rbrace_tok = current_token();
 
         // 普遍性 G 错误检查：仅在是函数体、返回 int 且不保证返回时报错
         if (is_func_body && current_func_return_type == "int" && !block_guarantees_return) {
             ERROR_g(rbrace_tok.line); // 报告 '}' 所在的行号
         }
 
-        match("RBRACE");
+        match(TokenKind::RBRACE);
 
         // 移除旧的状态恢复
 
@@ -1592,7 +1786,7 @@ private:
 
     // BlockItem -> Decl | Stmt
     void parseBlockItem() {
-        if (current_token().type == "CONSTTK" || current_token().type == "STATICTK" || current_token().type == "INTTK") {
+        if (current_kind() == TokenKind::CONSTTK || current_kind() == TokenKind::STATICTK || current_kind() == TokenKind::INTTK) {
             parseDecl();
         } else {
             parseStmt();
@@ -1602,20 +1796,18 @@ private:
 
     // Stmt 规则 (注意 Block 需创建新作用域，LVal 需前瞻)
     bool parseStmt() {
-        const Token& T1 = current_token();
+        const Token T1 = current_token();
 
-        if (T1.type == "LBRACE") {
+        if (T1.kind == TokenKind::LBRACE) {
             enter_scope();
             // 传入 false，这不是函数体块
             bool block_guarantees_return = parseBlock(false);
             exit_scope();
             print_non_terminal("Stmt");
             return block_guarantees_return; // 返回子块的状态
-        } else if (T1.type == "IFTK") {
-            match("IFTK");
-            match("LPARENT");
-            IRValue cond_val =parseCond();
-            match_with_error_check("RPARENT", 'j', peek(-1).line);
+        } else if (T1.kind == TokenKind::IFTK) {
+            match(TokenKind::IFTK);
+            match(TokenKind::LPARENT);
 
             // 声明局部变量，用于追踪 if 和 else 分支是否保证返回
             std::string true_label = ir_generator.new_label("if_then");
@@ -1624,8 +1816,9 @@ private:
             bool then_block_terminated = false;
             bool else_block_terminated = false;
             // --- IR Generation Step 3: 终止当前块，跳转到 true/false 分支 ---
-            // 必须在执行 if 语句体之前，用条件分支指令 `br i1` 结束当前基本块。
-            ir_generator.write_func("br i1 " + cond_val.name + ", label %" + true_label + ", label %" + false_label);
+            // * 条件按跳转代码生成，直接以条件分支链结束当前基本块
+            parseCondJump(true_label, false_label);
+            match_with_error_check(TokenKind::RPARENT, 'j', peek(-1).line);
 
             // 声明局部变量，用于追踪 if 和 else 分支是否保证返回
             // 4.1 开始 'then' 块
@@ -1644,8 +1837,8 @@ private:
             bool else_branch_guarantees = false;
 
             // 5.2 解析 'else'
-            if (current_token().type == "ELSETK") {
-                match("ELSETK");
+            if (current_kind() == TokenKind::ELSETK) {
+                match(TokenKind::ELSETK);
                 else_branch_guarantees = parseStmt(); // 生成 else 语句体 IR
                 else_block_terminated = basic_block_terminated;
             }
@@ -1665,14 +1858,14 @@ private:
 
             // 核心：只有 if 和 else 分支都保证返回时，整个 if 语句才保证返回
             return if_branch_guarantees && else_branch_guarantees;
-        } else if (T1.type == "FORTK") {
+        } else if (T1.kind == TokenKind::FORTK) {
             // ... (FOR 循环的解析代码不变) ...
-            match("FORTK");
-            match("LPARENT");
-            if (current_token().type != "SEMICN") {
+            match(TokenKind::FORTK);
+            match(TokenKind::LPARENT);
+            if (current_kind() != TokenKind::SEMICN) {
                 parseForStmt();
             }// [ForStmt]
-            match("SEMICN");
+            match(TokenKind::SEMICN);
             std::string cond_label = ir_generator.new_label("for_cond");
             std::string body_label = ir_generator.new_label("for_body");
             std::string inc_label  = ir_generator.new_label("for_inc");
@@ -1683,20 +1876,19 @@ private:
 
             // 3. Cond (条件判断块)
             ir_generator.write_func("\n" + cond_label + ":");
-            if (current_token().type != "SEMICN") {
-                IRValue cond_val =parseCond();
-                ir_generator.write_func("br i1 " + cond_val.name + ", label %" + body_label + ", label %" + end_label);
+            if (current_kind() != TokenKind::SEMICN) {
+                parseCondJump(body_label, end_label);
             }else {
                 // 空条件默认为真，直接跳 body
                 ir_generator.write_func("br label %" + body_label);
             }// [Cond]
-            match("SEMICN");
+            match(TokenKind::SEMICN);
             size_t inc_start_index = current_index;
             int paren_depth = 0;
             while (current_index < g_tokens.size()) {
-                if (g_tokens[current_index].type == "LPARENT") {
+                if (g_tokens.kinds[current_index] == TokenKind::LPARENT) {
                     paren_depth++;
-                } else if (g_tokens[current_index].type == "RPARENT") {
+                } else if (g_tokens.kinds[current_index] == TokenKind::RPARENT) {
                     if (paren_depth == 0) {
                         break; // 找到了 for 循环结束的括号
                     }
@@ -1704,7 +1896,7 @@ private:
                 }
                 current_index++;
             } // [ForStmt]
-            match_with_error_check("RPARENT", 'j', peek(-1).line);
+            match_with_error_check(TokenKind::RPARENT, 'j', peek(-1).line);
             ir_generator.write_func("\n" + body_label + ":");
             loop_depth_counter++;
             basic_block_terminated = false;
@@ -1719,7 +1911,7 @@ private:
 
             size_t body_end_index = current_index;
             current_index = inc_start_index;
-            if (current_token().type != "RPARENT") {
+            if (current_kind() != TokenKind::RPARENT) {
                 parseForStmt(); // 解析 Inc，此时生成的 IR 编号是递增后的正确编号
             }
             // Inc 执行完跳转回 Cond
@@ -1731,39 +1923,39 @@ private:
             loop_end_labels.pop();
             print_non_terminal("Stmt");
             return false; // FOR 循环不保证返回
-        } else if (T1.type == "BREAKTK") {
+        } else if (T1.kind == TokenKind::BREAKTK) {
             // ... (BREAK 的解析代码不变) ...
             int line = T1.line;
-            match("BREAKTK");
+            match(TokenKind::BREAKTK);
             if (loop_depth_counter == 0) {
                 ERROR_m(line);
             }
-            match_with_error_check("SEMICN", 'i', line);
+            match_with_error_check(TokenKind::SEMICN, 'i', line);
             if (!loop_end_labels.empty()) {
                 ir_generator.write_func("br label %" + loop_end_labels.top());
             }
             print_non_terminal("Stmt");
             basic_block_terminated = true;
             return false; // BREAK 不保证返回
-        } else if (T1.type == "CONTINUETK") {
+        } else if (T1.kind == TokenKind::CONTINUETK) {
             // ... (CONTINUE 的解析代码不变) ...
             int line = T1.line;
-            match("CONTINUETK");
+            match(TokenKind::CONTINUETK);
             if (loop_depth_counter == 0) {
                 ERROR_m(line);
             }
-            match_with_error_check("SEMICN", 'i', line);
+            match_with_error_check(TokenKind::SEMICN, 'i', line);
             if (!loop_inc_labels.empty()) {
                 ir_generator.write_func("br label %" + loop_inc_labels.top());
             }
             print_non_terminal("Stmt");
             basic_block_terminated = true;
             return false; // CONTINUE 不保证返回
-        } else if (T1.type == "RETURNTK") {
+        } else if (T1.kind == TokenKind::RETURNTK) {
             Token return_tok = current_token();
-            match("RETURNTK");
+            match(TokenKind::RETURNTK);
             bool has_return_value = false;
-            if (current_token().type != "SEMICN") {
+            if (current_kind() != TokenKind::SEMICN) {
                 IRValue ret_val =parseExp();
                 ir_generator.write_func("ret i32 " + ret_val.name);
                 has_return_value=true;
@@ -1775,11 +1967,11 @@ private:
                 ERROR_f(return_tok.line);
             }
             // 移除旧的 block_contains_return = true;
-            match_with_error_check("SEMICN", 'i', peek(-1).line);
+            match_with_error_check(TokenKind::SEMICN, 'i', peek(-1).line);
             print_non_terminal("Stmt");
             basic_block_terminated = true;
             return true; // RETURNTK 保证返回
-        } else if (T1.type == "PRINTFTK") {
+        } else if (T1.kind == TokenKind::PRINTFTK) {
             parsePrintfStmt();
             print_non_terminal("Stmt");
             return false; // PRINTF 不保证返回
@@ -1787,15 +1979,15 @@ private:
             // --- LVal='Exp';  VS  LVal=='Exp';  VS  [Exp]';' ---
         else {
             // ... (原有的赋值和表达式语句解析逻辑) ...
-            const Token& T_start = current_token();
+            const Token T_start = current_token();
 
             // 1. **【分支 1：LVal 开头的高级前瞻】**
-            if (T_start.type == "IDENFR") {
+            if (T_start.kind == TokenKind::IDENFR) {
 
                 size_t lookahead_index = current_index + 1;
                 while (lookahead_index < g_tokens.size()) {
-                    const std::string& type = g_tokens[lookahead_index].type;
-                    if (type == "LBRACK" || type == "RBRACK" || type == "INTCON" || type == "IDENFR" || type == "LPARENT" || type == "RPARENT" || type == "PLUS" || type == "MINU" || type == "MULT" || type == "DIV" || type == "MOD"||type == "COMMA") {
+                    const TokenKind type = g_tokens.kinds[lookahead_index];
+                    if (type == TokenKind::LBRACK || type == TokenKind::RBRACK || type == TokenKind::INTCON || type == TokenKind::IDENFR || type == TokenKind::LPARENT || type == TokenKind::RPARENT || type == TokenKind::PLUS || type == TokenKind::MINU || type == TokenKind::MULT || type == TokenKind::DIV || type == TokenKind::MOD||type == TokenKind::COMMA) {
                         lookahead_index++;
                     } else {
                         break;
@@ -1803,28 +1995,28 @@ private:
                 }
 
                 if (lookahead_index < g_tokens.size()) {
-                    const std::string& next_type = g_tokens[lookahead_index].type;
+                    const TokenKind next_type = g_tokens.kinds[lookahead_index];
 
                     // b. **识别 ASSIGN**
-                    if (next_type == "ASSIGN") {
+                    if (next_type == TokenKind::ASSIGN) {
                         IRValue dest_addr =parseLVal(true);
-                        match("ASSIGN");
+                        match(TokenKind::ASSIGN);
                         IRValue src_val=parseExp();
                         ir_generator.write_func(
                                 "store i32 " + src_val.name + ", i32* " + dest_addr.name + ", align 4"
                         );
-                        match_with_error_check("SEMICN", 'i', peek(-1).line);
+                        match_with_error_check(TokenKind::SEMICN, 'i', peek(-1).line);
                         print_non_terminal("Stmt");
                         return false; // 赋值不保证返回
                     }
 
                         // c. **【识别高级表达式语句】**
-                    else if (next_type == "EQL" || next_type == "NEQ" || next_type == "LSS" ||
-                             next_type == "GRE" || next_type == "LEQ" || next_type == "GEQ" ||
-                             next_type == "AND" || next_type == "OR")
+                    else if (next_type == TokenKind::EQL || next_type == TokenKind::NEQ || next_type == TokenKind::LSS ||
+                             next_type == TokenKind::GRE || next_type == TokenKind::LEQ || next_type == TokenKind::GEQ ||
+                             next_type == TokenKind::AND || next_type == TokenKind::OR)
                     {
                         parseCond();
-                        match_with_error_check("SEMICN", 'i', peek(-1).line);
+                        match_with_error_check(TokenKind::SEMICN, 'i', peek(-1).line);
                         print_non_terminal("Stmt");
                         return false; // 表达式不保证返回
                     }
@@ -1835,17 +2027,17 @@ private:
                 int line_for_error = T_start.line;
                 size_t start_index = current_index;
 
-                if (current_token().type != "SEMICN") {
+                if (current_kind() != TokenKind::SEMICN) {
                     parseExp();
                     line_for_error = peek(-1).line;
                 }
 
-                match_with_error_check("SEMICN", 'i', line_for_error);
+                match_with_error_check(TokenKind::SEMICN, 'i', line_for_error);
 
                 if (current_index == start_index &&
-                    current_token().type != "SEMICN" &&
-                    current_token().type != "RBRACE" &&
-                    current_token().type != "EOF")
+                    current_kind() != TokenKind::SEMICN &&
+                    current_kind() != TokenKind::RBRACE &&
+                    current_kind() != TokenKind::END)
                 {
                     current_index++;
                 }
@@ -1858,17 +2050,17 @@ private:
                 int line_for_error = T_start.line;
                 size_t start_index = current_index;
 
-                if (current_token().type != "SEMICN") {
+                if (current_kind() != TokenKind::SEMICN) {
                     parseExp();
                     line_for_error = peek(-1).line;
                 }
 
-                match_with_error_check("SEMICN", 'i', line_for_error);
+                match_with_error_check(TokenKind::SEMICN, 'i', line_for_error);
 
                 if (current_index == start_index &&
-                    current_token().type != "SEMICN" &&
-                    current_token().type != "RBRACE" &&
-                    current_token().type != "EOF")
+                    current_kind() != TokenKind::SEMICN &&
+                    current_kind() != TokenKind::RBRACE &&
+                    current_kind() != TokenKind::END)
                 {
                     current_index++;
                 }
@@ -1882,13 +2074,13 @@ private:
     // ForStmt -> LVal '=' Exp { ',' LVal '=' Exp }
     void parseForStmt() {
         IRValue dest =parseLVal(true);
-        match("ASSIGN");
+        match(TokenKind::ASSIGN);
         IRValue src =parseExp();
         ir_generator.write_func("store i32 " + src.name + ", i32* " + dest.name + ", align 4");
-        while (current_token().type == "COMMA") {
-            match("COMMA");
+        while (current_kind() == TokenKind::COMMA) {
+            match(TokenKind::COMMA);
             dest =parseLVal(true);
-            match("ASSIGN");
+            match(TokenKind::ASSIGN);
             src = parseExp();
             ir_generator.write_func("store i32 " + src.name + ", i32* " + dest.name + ", align 4");
         }
@@ -1897,18 +2089,18 @@ private:
 
     // Printf 语句
     void parsePrintfStmt() {
-        match("PRINTFTK");
-        match("LPARENT");
+        match(TokenKind::PRINTFTK);
+        match(TokenKind::LPARENT);
 
         // 用于收集表达式的 IRValue
         std::vector<IRValue> exp_list;
         Token strcon_tok = current_token();
 
         // 1. 处理格式字符串和表达式列表
-        match_with_error_check("STRCON", 'a', peek(-1).line); // A 错误检查
+        match_with_error_check(TokenKind::STRCON, 'a', peek(-1).line); // A 错误检查
 
         // 统计格式字符串中 %d 的数量
-        std::string format_str_value = strcon_tok.value;
+        std::string format_str_value(strcon_tok.value);
         int format_count = 0;
         for (size_t i = 0; i < format_str_value.length(); ++i) {
             if (format_str_value[i] == '%' && i + 1 < format_str_value.length() && format_str_value[i + 1] == 'd') {
@@ -1917,8 +2109,8 @@ private:
         }
 
         // 2. 处理后续 Exp
-        while (current_token().type == "COMMA") {
-            match("COMMA");
+        while (current_kind() == TokenKind::COMMA) {
+            match(TokenKind::COMMA);
             exp_list.push_back(parseExp()); // <-- 确保调用 IRValue 版本
         }
 
@@ -1927,8 +2119,8 @@ private:
             ERROR_l(strcon_tok.line);
         }
 
-        match_with_error_check("RPARENT", 'j', peek(-1).line);
-        match_with_error_check("SEMICN", 'i', peek(-1).line);
+        match_with_error_check(TokenKind::RPARENT, 'j', peek(-1).line);
+        match_with_error_check(TokenKind::SEMICN, 'i', peek(-1).line);
 
         // **IR Generation: Printf Logic**
 
@@ -1986,24 +2178,24 @@ private:
     // LVal -> Ident ['[' Exp ']']
     IRValue parseLVal(bool need_address) {
         Token ident_tok = current_token();
-        match("IDENFR");
+        const std::string ident_name(ident_tok.value);
+        match(TokenKind::IDENFR);
 
-        Symbol var_symbol;
-        bool declared = find_symbol(ident_tok.value, var_symbol);
-        if (!declared) {
+        const Symbol* var_symbol_ptr = find_symbol(ident_name);
+        if (!var_symbol_ptr) {
             ERROR_c(ident_tok.line);
             return {"0", "i32"};
-        } else {
-            if (need_address && var_symbol.is_const) {
-                ERROR_h(ident_tok.line);
-            }
+        }
+        const Symbol& var_symbol = *var_symbol_ptr;
+        if (need_address && var_symbol.is_const) {
+            ERROR_h(ident_tok.line);
         }
 
         // 1. 常量计算上下文处理
         if (is_const_context) {
             std::vector<int> indices;
-            while (current_token().type == "LBRACK") {
-                match("LBRACK");
+            while (current_kind() == TokenKind::LBRACK) {
+                match(TokenKind::LBRACK);
                 parseExp();
                 int idx_val = 0;
                 if (!const_value_stack.empty()) {
@@ -2011,7 +2203,7 @@ private:
                     const_value_stack.pop();
                 }
                 indices.push_back(idx_val);
-                match_with_error_check("RBRACK", 'k', peek(-1).line);
+                match_with_error_check(TokenKind::RBRACK, 'k', peek(-1).line);
             }
 
             if (var_symbol.is_const) {
@@ -2045,7 +2237,7 @@ private:
         }
 
         if (var_symbol.is_const) {
-            if (!need_address && var_symbol.dimensions.empty() && current_token().type != "LBRACK") {
+            if (!need_address && var_symbol.dimensions.empty() && current_kind() != TokenKind::LBRACK) {
                 if (var_symbol.llvm_name.empty()) return {"0", "i32"};
                 return {var_symbol.llvm_name, "i32"};
             }
@@ -2055,7 +2247,7 @@ private:
         bool skip_base_gep = false;
 
         if (var_symbol.is_param) {
-            if (!var_symbol.dimensions.empty() || current_token().type == "LBRACK") {
+            if (!var_symbol.dimensions.empty() || current_kind() == TokenKind::LBRACK) {
                 std::string loaded_ptr_reg = ir_generator.new_reg();
                 ir_generator.write_func("  " + loaded_ptr_reg + " = load i32*, i32** " + base_ptr + ", align 4");
                 base_ptr = loaded_ptr_reg;
@@ -2079,10 +2271,10 @@ private:
         bool has_index = false;
         int current_dim = 0; // 记录当前解析到了第几维
 
-        while (current_token().type == "LBRACK") {
-            match("LBRACK");
+        while (current_kind() == TokenKind::LBRACK) {
+            match(TokenKind::LBRACK);
             IRValue current_idx = parseExp();
-            match_with_error_check("RBRACK", 'k', peek(-1).line);
+            match_with_error_check(TokenKind::RBRACK, 'k', peek(-1).line);
             has_index = true;
 
             int stride = 1;
@@ -2158,6 +2350,70 @@ private:
         return cond_result; // <-- 返回包含寄存器名和类型（应为 "i1"）的 IRValue
     }
 
+    // Cond -> LOrExp，按跳转代码生成：条件为真跳到 true_label，为假跳到 false_label
+    // * 短路求值直接翻译为条件分支链，不再经由 i1 栈槽保存和合并结果
+    void parseCondJump(const std::string& true_label, const std::string& false_label) {
+        parseLOrJump(true_label, false_label);
+        print_non_terminal("Cond");
+    }
+
+    // LOrExp -> LAndExp { '||' LAndExp }：任一项为真即跳到 true_label
+    void parseLOrJump(const std::string& true_label, const std::string& false_label) {
+        while (true) {
+            // 在解析当前项之前确定其为假时的去向，此时还不知道后面是否有 '||'，先备好下一项的标签
+            std::string next_label = ir_generator.new_label("or_next");
+            bool has_next = parseLAndJump(true_label, false_label, next_label);
+            if (!has_next) break;
+            print_non_terminal("LOrExp");
+            match(TokenKind::OR);
+            ir_generator.write_func("\n" + next_label + ":");
+            basic_block_terminated = false;
+        }
+        print_non_terminal("LOrExp");
+    }
+
+    // 向前扫描当前 LAndExp 之后（同一括号层）是否还有 '||'
+    bool lor_follows() const {
+        int paren_depth = 0;
+        for (size_t i = current_index; i < g_tokens.size(); ++i) {
+            const TokenKind type = g_tokens.kinds[i];
+            if (type == TokenKind::LPARENT) {
+                paren_depth++;
+            } else if (type == TokenKind::RPARENT) {
+                if (paren_depth == 0) return false;
+                paren_depth--;
+            } else if (paren_depth == 0 && type == TokenKind::OR) {
+                return true;
+            } else if (type == TokenKind::SEMICN || type == TokenKind::LBRACE || type == TokenKind::RBRACE) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // LAndExp -> EqExp { '&&' EqExp }：任一项为假即跳到假出口
+    // 假出口在后面还有 '||' 时为 or_next，否则为 false_label；返回后面是否还有 '||'
+    bool parseLAndJump(const std::string& true_label, const std::string& false_label, const std::string& or_next_label) {
+        std::string false_target = lor_follows() ? or_next_label : false_label;
+        while (true) {
+            IRValue val = convert_to_i1(parseEqExp());
+            bool more_and = current_kind() == TokenKind::AND;
+            bool more_or = current_kind() == TokenKind::OR;
+            if (more_and) {
+                std::string next_label = ir_generator.new_label("and_next");
+                ir_generator.write_func("br i1 " + val.name + ", label %" + next_label + ", label %" + false_target);
+                print_non_terminal("LAndExp");
+                match(TokenKind::AND);
+                ir_generator.write_func("\n" + next_label + ":");
+                basic_block_terminated = false;
+                continue;
+            }
+            ir_generator.write_func("br i1 " + val.name + ", label %" + true_label + ", label %" + false_target);
+            print_non_terminal("LAndExp");
+            return more_or;
+        }
+    }
+
     // ConstExp -> AddExp (涉及的 Ident 必须是常量)
     IRValue parseConstExp() {
         IRValue result = parseAddExp(); // 语法结构与 AddExp 相同
@@ -2190,7 +2446,7 @@ private:
         result = convert_to_i1(result);
 
         // 如果没有 ||，直接返回
-        if (current_token().type != "OR") {
+        if (current_kind() != TokenKind::OR) {
             print_non_terminal("LOrExp");
             return result;
         }
@@ -2203,9 +2459,9 @@ private:
         // 将左操作数的值存入
         ir_generator.write_func("store i1 " + result.name + ", i1* " + res_ptr + ", align 1");
 
-        while (current_token().type == "OR") {
+        while (current_kind() == TokenKind::OR) {
             print_non_terminal("LOrExp");
-            match("OR");
+            match(TokenKind::OR);
 
             // 创建基本块标签
             std::string true_label = ir_generator.new_label("or_true");   // 左侧为真，直接短路
@@ -2249,7 +2505,7 @@ private:
         IRValue result = parseEqExp();
         result = convert_to_i1(result);
 
-        if (current_token().type != "AND") {
+        if (current_kind() != TokenKind::AND) {
             print_non_terminal("LAndExp");
             return result;
         }
@@ -2262,9 +2518,9 @@ private:
         // 存储左操作数
         ir_generator.write_func("store i1 " + result.name + ", i1* " + res_ptr + ", align 1");
 
-        while (current_token().type == "AND") {
+        while (current_kind() == TokenKind::AND) {
             print_non_terminal("LAndExp");
-            match("AND");
+            match(TokenKind::AND);
 
             std::string false_label = ir_generator.new_label("and_false"); // 左侧为假，短路
             std::string calc_label = ir_generator.new_label("and_calc");   // 左侧为真，计算右侧
@@ -2304,8 +2560,8 @@ private:
     IRValue parseEqExp() {
         IRValue result = parseRelExp();
 
-        while (current_token().type == "EQL" || current_token().type == "NEQ") {
-            std::string op = current_token().type;
+        while (current_kind() == TokenKind::EQL || current_kind() == TokenKind::NEQ) {
+            TokenKind op = current_kind();
             print_non_terminal("EqExp");
             match(op);
 
@@ -2316,7 +2572,7 @@ private:
             val2 = ensure_i32(val2);
 
             // 2. 生成 icmp 指令，将 i32 结果转换为 i1
-            std::string predicate = (op == "EQL") ? "eq" : "ne";
+            std::string predicate = (op == TokenKind::EQL) ? "eq" : "ne";
             std::string result_reg = ir_generator.new_reg();
             std::string ir_line = result_reg + " = icmp " + predicate + " i32 " + result.name + ", " + val2.name;
             ir_generator.write_func(ir_line);
@@ -2333,10 +2589,10 @@ private:
     IRValue parseRelExp() {
         IRValue result = parseAddExp(); // i32 值
 
-        while (current_token().type == "LSS" || current_token().type == "GRE" ||
-               current_token().type == "LEQ" || current_token().type == "GEQ") {
+        while (current_kind() == TokenKind::LSS || current_kind() == TokenKind::GRE ||
+               current_kind() == TokenKind::LEQ || current_kind() == TokenKind::GEQ) {
 
-            std::string op = current_token().type;
+            TokenKind op = current_kind();
             print_non_terminal("RelExp");
             match(op);
 
@@ -2345,10 +2601,10 @@ private:
             val2 = ensure_i32(val2);
             // 1. 选择 LLVM 谓词 (icmp predicate)
             std::string predicate;
-            if (op == "LSS") predicate = "slt"; // <
-            else if (op == "GRE") predicate = "sgt"; // >
-            else if (op == "LEQ") predicate = "sle"; // <=
-            else if (op == "GEQ") predicate = "sge"; // >=
+            if (op == TokenKind::LSS) predicate = "slt"; // <
+            else if (op == TokenKind::GRE) predicate = "sgt"; // >
+            else if (op == TokenKind::LEQ) predicate = "sle"; // <=
+            else if (op == TokenKind::GEQ) predicate = "sge"; // >=
 
             // 2. 生成 icmp 指令，将 i32 结果转换为 i1
             std::string result_reg = ir_generator.new_reg();
@@ -2368,10 +2624,10 @@ private:
     // AddExp -> MulExp { ('+' | '-') MulExp }
     IRValue parseAddExp() {
         IRValue left_val = parseMulExp();
-        while (current_token().type == "PLUS" || current_token().type == "MINU") {
+        while (current_kind() == TokenKind::PLUS || current_kind() == TokenKind::MINU) {
             print_non_terminal("AddExp");
-            std::string op = current_token().value;
-            match(current_token().type);
+            TokenKind op = current_kind();
+            match(op);
             //parseMulExp();
             IRValue right_val = parseMulExp();
             if (is_const_context) {
@@ -2380,12 +2636,12 @@ private:
                     int r_val = const_value_stack.top().value; const_value_stack.pop();
                     int l_val = const_value_stack.top().value; const_value_stack.pop();
                     int res = 0;
-                    if (op == "+") res = l_val + r_val;
+                    if (op == TokenKind::PLUS) res = l_val + r_val;
                     else res = l_val - r_val;
                     const_value_stack.push({res, true});
                 }
             }
-            std::string op_code = (op == "+") ? "add nsw" : "sub nsw";
+            std::string op_code = (op == TokenKind::PLUS) ? "add nsw" : "sub nsw";
             std::string result_reg = ir_generator.new_reg();
             ir_generator.write_func(
                     result_reg + " = " + op_code + " i32 " + left_val.name + ", " + right_val.name
@@ -2401,10 +2657,10 @@ private:
     // MulExp -> UnaryExp { ('*' | '/' | '%') UnaryExp }
     IRValue parseMulExp() {
         IRValue left_val = parseUnaryExp();
-        while (current_token().type == "MULT" || current_token().type == "DIV" || current_token().type == "MOD") {
+        while (current_kind() == TokenKind::MULT || current_kind() == TokenKind::DIV || current_kind() == TokenKind::MOD) {
             print_non_terminal("MulExp");
-            std::string op = current_token().value;
-            match(current_token().type);
+            TokenKind op = current_kind();
+            match(op);
             //parseUnaryExp();
             IRValue right_val = parseUnaryExp();
             if (is_const_context) {
@@ -2412,16 +2668,16 @@ private:
                     int r_val = const_value_stack.top().value; const_value_stack.pop();
                     int l_val = const_value_stack.top().value; const_value_stack.pop();
                     int res = 0;
-                    if (op == "*") res = l_val * r_val;
-                    else if (op == "/") res = (r_val != 0) ? l_val / r_val : 0; // 防止除0崩溃
-                    else if (op == "%") res = (r_val != 0) ? l_val % r_val : 0;
+                    if (op == TokenKind::MULT) res = l_val * r_val;
+                    else if (op == TokenKind::DIV) res = (r_val != 0) ? l_val / r_val : 0; // 防止除0崩溃
+                    else if (op == TokenKind::MOD) res = (r_val != 0) ? l_val % r_val : 0;
                     const_value_stack.push({res, true});
                 }
             }
             std::string op_code;
-            if (op == "*") op_code = "mul nsw";
-            else if (op == "/") op_code = "sdiv";
-            else if (op == "%") op_code = "srem";
+            if (op == TokenKind::MULT) op_code = "mul nsw";
+            else if (op == TokenKind::DIV) op_code = "sdiv";
+            else if (op == TokenKind::MOD) op_code = "srem";
             std::string result_reg = ir_generator.new_reg();
             ir_generator.write_func(
                     result_reg + " = " + op_code + " i32 " + left_val.name + ", " + right_val.name
@@ -2437,41 +2693,41 @@ private:
 
     // UnaryExp -> PrimaryExp | Ident '(' [FuncRParams] ')' | UnaryOp UnaryExp
     IRValue parseUnaryExp() {
-        const std::string& T1 = current_token().type;
-        const std::string& T2 = peek(1).type;
+        const TokenKind T1 = current_kind();
+        const TokenKind T2 = peek(1).kind;
 
         IRValue result_val;
 
         // 1. UnaryOp 开头 (+, -, !)
-        if (T1 == "PLUS" || T1 == "MINU" || T1 == "NOT") {
-            std::string op = current_token().value;
+        if (T1 == TokenKind::PLUS || T1 == TokenKind::MINU || T1 == TokenKind::NOT) {
+            TokenKind op = T1;
             match(T1);
             print_non_terminal("UnaryOp");
 
             IRValue operand = parseUnaryExp();
             if (is_const_context && !const_value_stack.empty()) {
-                if (op == "-") {
+                if (op == TokenKind::MINU) {
                     int val = const_value_stack.top().value;
                     const_value_stack.pop();
                     const_value_stack.push({-val, true});
-                } else if (op == "!") {
+                } else if (op == TokenKind::NOT) {
                     int val = const_value_stack.top().value;
                     const_value_stack.pop();
                     const_value_stack.push({!val, true});
                 }
             }
 
-            if (op == "-") {
+            if (op == TokenKind::MINU) {
                 std::string result_reg = ir_generator.new_reg();
                 ir_generator.write_func(
                         result_reg + " = sub i32 0, " + operand.name
                 );
                 result_val = {result_reg, "i32"};
             }
-            else if (op == "+") {
+            else if (op == TokenKind::PLUS) {
                 result_val = operand;
             }
-            else if (op == "!") {
+            else if (op == TokenKind::NOT) {
                 std::string result_reg = ir_generator.new_reg();
                 ir_generator.write_func(
                         result_reg + " = icmp eq i32 " + operand.name + ", 0"
@@ -2484,21 +2740,24 @@ private:
             }
         }
             // 2. 函数调用 Ident '(' [FuncRParams] ')'
-        else if (T1 == "IDENFR" && T2 == "LPARENT") {
+        else if (T1 == TokenKind::IDENFR && T2 == TokenKind::LPARENT) {
             Token ident_tok = current_token();
-            match("IDENFR");
+            const std::string ident_name(ident_tok.value);
+            match(TokenKind::IDENFR);
 
-            Symbol func_symbol;
-            bool declared = find_symbol(ident_tok.value, func_symbol);
+            static const Symbol undeclared_symbol{};
+            const Symbol* func_symbol_ptr = find_symbol(ident_name);
+            bool declared = func_symbol_ptr != nullptr;
             if (!declared) { ERROR_c(ident_tok.line); }
+            const Symbol& func_symbol = declared ? *func_symbol_ptr : undeclared_symbol;
             // 语义检查：B 错误检查省略，假设语义正确
 
-            match("LPARENT");
+            match(TokenKind::LPARENT);
 
             std::vector<IRValue> actual_ir_args;
             std::vector<std::string> actual_types;
 
-            if (current_token().type != "RPARENT") {
+            if (current_kind() != TokenKind::RPARENT) {
                 size_t param_index = 0;
                 do {
                     // 【修改点】: 移除了原来针对 int[] 的复杂特判逻辑
@@ -2515,11 +2774,11 @@ private:
                     actual_ir_args.push_back(arg_val);
                     param_index++;
 
-                } while (current_token().type == "COMMA" && (match("COMMA"), true));
+                } while (current_kind() == TokenKind::COMMA && (match(TokenKind::COMMA), true));
             }
             int actual_param_count = actual_types.size();
 
-            match_with_error_check("RPARENT", 'j', ident_tok.line);
+            match_with_error_check(TokenKind::RPARENT, 'j', ident_tok.line);
 
             // 2. 集中进行 d 和 e 检查
             if (declared && func_symbol.param_count >= 0) {
@@ -2583,9 +2842,9 @@ private:
             // 3. 收集 IRValue 和语义类型
             result.ir_values.push_back(arg_ir_value);
             result.semantic_types.push_back("int");
-            if (current_token().type != "COMMA") break;
+            if (current_kind() != TokenKind::COMMA) break;
 
-            match("COMMA");
+            match(TokenKind::COMMA);
         }
 
         print_non_terminal("FuncRParams");
@@ -2594,22 +2853,22 @@ private:
     }
     // PrimaryExp -> '(' Exp ')' | LVal | Number (INTCON)
     IRValue parsePrimaryExp() {
-        const std::string& type = current_token().type;
+        const TokenKind type = current_kind();
         IRValue exp_type ;
 
-        if (type == "LPARENT") {
-            match("LPARENT");
+        if (type == TokenKind::LPARENT) {
+            match(TokenKind::LPARENT);
             exp_type = parseExp();
-            match_with_error_check("RPARENT", 'j', peek(-1).line);
-        } else if (type == "INTCON") {
-            int val = std::stoi(current_token().value); // 获取整数值
+            match_with_error_check(TokenKind::RPARENT, 'j', peek(-1).line);
+        } else if (type == TokenKind::INTCON) {
+            int val = std::stoi(std::string(current_token().value)); // 获取整数值
             if (is_const_context) {
                 const_value_stack.push({val, true}); // 【新增】压入栈
             }
-            exp_type = {current_token().value, "i32"};
-            match("INTCON");
+            exp_type = {std::string(current_token().value), "i32"};
+            match(TokenKind::INTCON);
             print_non_terminal("Number");
-        } else if(type == "IDENFR") {
+        } else if(type == TokenKind::IDENFR) {
             exp_type = parseLVal(false); // 捕获 LVal 类型
             if (is_const_context) {
                 int val = 0;
@@ -2634,9 +2893,8 @@ private:
 
 
 public:
-    Parser(const char* outfile_path) : current_index(0) {
-        output_file = fopen(outfile_path, "w");
-        if (!output_file) {
+    Parser(const char* outfile_path, const char* error_file_path) : current_index(0), error_path(error_file_path) {
+        if (g_artifacts.parser && !output_file.open(outfile_path)) {
             fprintf(stderr, "Failed to open parser output file.\n");
             exit(1);
         }
@@ -2646,29 +2904,47 @@ public:
         g_builtin_symbols["printf"] = {"printf", "void", false, false, {}, 0, 0, -1, {}};
     }
 
-    ~Parser() {
-        if (output_file) fclose(output_file);
-    }
     std::string get_final_ir() {
         return ir_generator.get_final_ir();
     }
     void parse() {
         parseCompUnit();
-        if (current_token().type != "EOF") {
+        if (current_kind() != TokenKind::END) {
             fprintf(stderr, "Parsing finished, but unexpected tokens remain starting at line %d.\n", current_token().line);
-            exit(1);
+            abort_parse();
         }
     }
 };
 
 // --- 第四部分：Main 函数和驱动逻辑 ---
 
-// [省略 main 函数中的文件路径定义和 pretreatment 调用]
 #include <iostream>
 #include <fstream>
 #include "MipsGenerator.h"
-
-int main() {
+#include "IRModule.h"
+#include "IROptimizer.h"
+
+int main(int argc, char* argv[]) {
+    // 可选参数 -unroll=N：循环展开的指令数预算（0 关闭展开），用代码体积换速度
+    // 可选参数 -emit=a,b,...：额外输出的中间产物（preprocessed, lexer, parser, symbol, error, llvm, all），默认只输出 mips.txt
+    // -emit-llvm / -emit-preprocessed 等价于 -emit=llvm / -emit=preprocessed
+    int unroll_budget = IROptimizer::DEFAULT_UNROLL_BUDGET;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "-unroll=", 8) == 0) unroll_budget = atoi(argv[i] + 8);
+        else if (strcmp(argv[i], "-emit-llvm") == 0) g_artifacts.llvm = true;
+        else if (strcmp(argv[i], "-emit-preprocessed") == 0) g_artifacts.preprocessed = true;
+        else if (strncmp(argv[i], "-emit=", 6) == 0) {
+            std::string_view list(argv[i] + 6);
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                std::string_view name = list.substr(0, comma);
+                if (!name.empty() && !g_artifacts.enable(name)) {
+                    fprintf(stderr, "Warning: unknown artifact '%.*s' ignored.\n", (int)name.size(), name.data());
+                }
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            }
+        }
+    }
     // 假设您的源代码文件名为 testfile.txt
 //    char yuan[] = "C:\\Users\\W\\CLionProjects\\Compiler\\testfile.txt";
 //    const char yuchli[] = "C:\\Users\\W\\CLionProjects\\Compiler\\preprocessing.txt";
@@ -2681,26 +2957,19 @@ int main() {
     const char error_path[] = "error.txt";
     const char parser_output_path[] = "parser.txt";
 
-    pretreatment(yuan, yuchli);
-    FILE* check_file = fopen(yuchli, "r");
-    if (check_file == nullptr) {
+    // 1. 预处理：注释已在词法分析中跳过，只在需要时单独输出
+    if (g_artifacts.preprocessed) pretreatment(yuan, yuchli);
+
+    // 2. 词法分析 (读取源文件，填充 g_tokens)
+    if (!lexical_analysis(yuan, cifa)) {
         fprintf(stderr, "Error: Source file '%s' not found.\n", yuan);
         return 1;
     }
-    fclose(check_file);
-
-    // 1. 预处理 (您需要自己实现此部分，此处仅为调用)
-    // pretreatment(yuan, yuchli);
-
-    // 2. 词法分析 (填充 g_tokens)
-    // 假设 yuchli 存在或直接使用 yuan
-    lexical_analysis(yuchli, cifa, error_path);
     // 3. 语法分析和语义分析
-    Parser parser(parser_output_path);
+    Parser parser(parser_output_path, error_path);
     parser.parse();
 
-    if(g_error_file) fclose(g_error_file);
-    sort_error_file(error_path);
+    if (g_artifacts.error) write_error_file(error_path);
     std::sort(g_symbol_output_records.begin(), g_symbol_output_records.end(),
               [](const SymbolOutputRecord& a, const SymbolOutputRecord& b) {
                   if (a.scope_id != b.scope_id) {
@@ -2714,36 +2983,45 @@ int main() {
     // 4. 新增：LLVM IR 生成与输出
     std::string final_ir = parser.get_final_ir();
 
+    // * 中端优化：解析为内存 IR，运行优化 Pass；后端直接翻译内存 IR
+    IRModule ir_module = IRModule::parse(final_ir);
+    IROptimizer optimizer(ir_module, unroll_budget);
+    optimizer.run();
+
     //const char llvm_ir_path[] = "C:\\Users\\W\\CLionProjects\\Compiler\\llvm_ir.txt";
     const char llvm_ir_path[] = "llvm_ir.txt";
     // 如果在非 Windows 环境，建议使用相对路径：const char llvm_ir_path[] = "llvm_ir.txt";
 
-    std::ofstream llvm_ir_file(llvm_ir_path);
-    if (llvm_ir_file.is_open()) {
-        llvm_ir_file << final_ir;
-        llvm_ir_file.close();
-    } else {
-        fprintf(stderr, "Error: Failed to open llvm_ir.txt for writing.\n");
-        return 1;
+    if (g_artifacts.llvm) {
+        std::ofstream llvm_ir_file(llvm_ir_path);
+        if (llvm_ir_file.is_open()) {
+            llvm_ir_file << ir_module.toString();
+            llvm_ir_file.close();
+        } else {
+            fprintf(stderr, "Error: Failed to open llvm_ir.txt for writing.\n");
+            return 1;
+        }
     }
     // 输出到 symbol.txt
-    //g_symbol_file = fopen("C:\\Users\\W\\CLionProjects\\Compiler\\symbol.txt", "w");
-    g_symbol_file = fopen("symbol.txt", "w");
-    if (g_symbol_file == nullptr) {
-        fprintf(stderr, "Error: Failed to open symbol file (symbol.txt) for writing.\\n");
-        // 在这里执行清理工作并安全退出
-        return 1;
-    }
-    if (g_symbol_file) {
+    //const char symbol_path[] = "C:\\Users\\W\\CLionProjects\\Compiler\\symbol.txt";
+    const char symbol_path[] = "symbol.txt";
+    if (g_artifacts.symbol) {
+        ArtifactWriter symbol_file;
+        if (!symbol_file.open(symbol_path)) {
+            fprintf(stderr, "Error: Failed to open symbol file (symbol.txt) for writing.\n");
+            // 在这里执行清理工作并安全退出
+            return 1;
+        }
         for (const auto& record : g_symbol_output_records) {
-            fprintf(g_symbol_file, "%d %s %s\n",
-                    record.scope_id,
-                    record.name.c_str(),
-                    record.type_name.c_str());
+            symbol_file.write(record.scope_id);
+            symbol_file.write(' ');
+            symbol_file.write(record.name);
+            symbol_file.write(' ');
+            symbol_file.write(record.type_name);
+            symbol_file.write('\n');
         }
-        fclose(g_symbol_file);
     }
-    MipsGenerator generator("llvm_ir.txt", "mips.txt");
+    MipsGenerator generator(ir_module, "mips.txt");
     generator.generate();
     return 0;
 }
\ No newline at end of file